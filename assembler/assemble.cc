@@ -0,0 +1,393 @@
+#include "assembler/assemble.h"
+
+#include <ctype.h>
+
+#include <algorithm>
+#include <charconv>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+#include "assembler/assembly_stats.h"
+#include "assembler/code.h"
+#include "assembler/parallel_assembler.h"
+#include "assembler/parser.h"
+
+namespace hack {
+
+namespace {
+
+// An A-instruction whose symbol was not yet defined when it was encoded.
+struct Fixup {
+  size_t word_index;
+
+  std::string_view symbol;
+};
+
+// Parses the decimal constant of an A-instruction such as @123.
+int ParseConstant(std::string_view digits) {
+  int n = 0;
+  std::from_chars(digits.data(), digits.data() + digits.size(), n);
+  return n;
+}
+
+// Returns the number of labels.
+size_t PopulateLabels(std::string_view source, SymbolTable& symbol_table) {
+  Parser parser(source);
+
+  int line_number = 0;
+  size_t num_labels = 0;
+  while (parser.HasMoreLines()) {
+    parser.Advance();
+    const Instruction& instruction = parser.CurrentInstruction();
+    if (instruction.instruction_type == InstructionType::kLInstruction) {
+      symbol_table.AddEntry(instruction.symbol, line_number);
+      num_labels++;
+    } else {
+      line_number++;
+    }
+  }
+  return num_labels;
+}
+
+// Allocates `symbol` as a variable if it is not a constant or already defined.
+int FindOrAllocate(std::string_view symbol, SymbolTable& symbol_table,
+                   int& next_variable_address) {
+  if (!symbol.empty() && isdigit(symbol[0])) {
+    return ParseConstant(symbol);
+  }
+  auto [n, inserted] =
+      symbol_table.FindOrInsert(symbol, next_variable_address);
+  if (inserted) {
+    next_variable_address++;
+  }
+  return n;
+}
+
+// Returns the value of `symbol` if it is a constant. Otherwise records a
+// fixup for the word at `word_index` and returns 0, since a later label may
+// still define the symbol or redefine it.
+int ParseOrDefer(std::string_view symbol, size_t word_index,
+                 std::vector<Fixup>& fixups) {
+  if (!symbol.empty() && isdigit(symbol[0])) {
+    return ParseConstant(symbol);
+  }
+  fixups.push_back({word_index, symbol});
+  return 0;
+}
+
+// Encodes an A- or C-instruction. `value` is the value of an A-instruction.
+uint16_t EncodeWord(const Instruction& instruction, int value) {
+  if (instruction.instruction_type == InstructionType::kAInstruction) {
+    // The top bit signifies it's an A-instruction. If we were error-handling
+    // we'd check that the value fit.
+    return static_cast<uint16_t>(value) & 0x7fff;
+  }
+  return EncodeCInstruction(instruction.destination, instruction.comparison,
+                            instruction.jump);
+}
+
+// When timing, instructions are handled in blocks of this many, one phase at a
+// time, so that the clock is read only a few times per block.
+constexpr size_t kBlockSize = 1024;
+
+// Parses up to kBlockSize A- and C-instructions into `block`, passing label
+// definitions to `on_label(instruction, address_in_block)`.
+template <typename OnLabel>
+void ParseBlock(Parser& parser, std::vector<Instruction>& block,
+                const OnLabel& on_label) {
+  block.clear();
+  while (block.size() < kBlockSize && parser.HasMoreLines()) {
+    parser.Advance();
+    const Instruction& instruction = parser.CurrentInstruction();
+    if (instruction.instruction_type == InstructionType::kLInstruction) {
+      on_label(instruction, block.size());
+    } else {
+      block.push_back(instruction);
+    }
+  }
+}
+
+// Parses `source` twice: once to collect labels, then again to encode. Phase
+// times are recorded only if `timed`, since splitting the second pass into
+// phases costs a few percent.
+std::vector<uint16_t> AssembleTwoPass(std::string_view source,
+                                      SymbolTable& symbol_table,
+                                      bool timed, AssemblyStats& stats) {
+  Stopwatch stopwatch;
+  stats.labels = PopulateLabels(source, symbol_table);
+  stopwatch.Lap(stats.label_collection_ns);
+
+  Parser parser(source);
+
+  std::vector<uint16_t> words;
+  words.reserve(std::count(source.begin(), source.end(), '\n') + 1);
+  int next_variable_address = kFirstVariableAddress;
+  if (!timed) {
+    while (parser.HasMoreLines()) {
+      parser.Advance();
+      const Instruction& instruction = parser.CurrentInstruction();
+      switch (instruction.instruction_type) {
+        case InstructionType::kLInstruction:
+          // Ignore pseudo-instruction.
+          break;
+
+        case InstructionType::kAInstruction:
+          // If it's not a label it's a new variable.
+          words.push_back(EncodeWord(
+              instruction, FindOrAllocate(instruction.symbol, symbol_table,
+                                          next_variable_address)));
+          break;
+
+        case InstructionType::kCInstruction:
+          words.push_back(EncodeWord(instruction, 0));
+          break;
+      }
+    }
+  } else {
+    std::vector<Instruction> block;
+    block.reserve(kBlockSize);
+    std::vector<int> values(kBlockSize);
+    while (parser.HasMoreLines()) {
+      ParseBlock(parser, block, [](const Instruction&, size_t) {});
+      stopwatch.Lap(stats.parsing_ns);
+
+      for (size_t i = 0; i < block.size(); i++) {
+        if (block[i].instruction_type == InstructionType::kAInstruction) {
+          values[i] = FindOrAllocate(block[i].symbol, symbol_table,
+                                     next_variable_address);
+        }
+      }
+      stopwatch.Lap(stats.symbol_resolution_ns);
+
+      for (size_t i = 0; i < block.size(); i++) {
+        words.push_back(EncodeWord(block[i], values[i]));
+      }
+      stopwatch.Lap(stats.encoding_ns);
+    }
+  }
+
+  stats.variables = next_variable_address - kFirstVariableAddress;
+  return words;
+}
+
+// Parses `source` once. Symbolic references are recorded and backpatched at
+// the end, when the last definition of every label is known: those that
+// turned out to be labels or predefined symbols get their value, the rest
+// become variables in order of first use, exactly as the two-pass assembler
+// would allocate them. Phase times are recorded only if `timed`.
+std::vector<uint16_t> AssembleSinglePass(std::string_view source,
+                                         SymbolTable& symbol_table,
+                                         bool timed, AssemblyStats& stats) {
+  Stopwatch stopwatch;
+  Parser parser(source);
+
+  std::vector<uint16_t> words;
+  words.reserve(std::count(source.begin(), source.end(), '\n') + 1);
+  std::vector<Fixup> fixups;
+  if (!timed) {
+    while (parser.HasMoreLines()) {
+      parser.Advance();
+      const Instruction& instruction = parser.CurrentInstruction();
+      switch (instruction.instruction_type) {
+        case InstructionType::kLInstruction:
+          symbol_table.AddEntry(instruction.symbol, words.size());
+          stats.labels++;
+          break;
+
+        case InstructionType::kAInstruction:
+          words.push_back(EncodeWord(
+              instruction,
+              ParseOrDefer(instruction.symbol, words.size(), fixups)));
+          break;
+
+        case InstructionType::kCInstruction:
+          words.push_back(EncodeWord(instruction, 0));
+          break;
+      }
+    }
+  } else {
+    std::vector<Instruction> block;
+    block.reserve(kBlockSize);
+    std::vector<int> values(kBlockSize);
+    while (parser.HasMoreLines()) {
+      ParseBlock(parser, block,
+                 [&](const Instruction& label, size_t address_in_block) {
+                   symbol_table.AddEntry(label.symbol,
+                                         words.size() + address_in_block);
+                   stats.labels++;
+                 });
+      stopwatch.Lap(stats.parsing_ns);
+
+      for (size_t i = 0; i < block.size(); i++) {
+        if (block[i].instruction_type == InstructionType::kAInstruction) {
+          values[i] = ParseOrDefer(block[i].symbol, words.size() + i, fixups);
+        }
+      }
+      stopwatch.Lap(stats.symbol_resolution_ns);
+
+      for (size_t i = 0; i < block.size(); i++) {
+        words.push_back(EncodeWord(block[i], values[i]));
+      }
+      stopwatch.Lap(stats.encoding_ns);
+    }
+  }
+
+  int next_variable_address = kFirstVariableAddress;
+  for (const Fixup& fixup : fixups) {
+    int n = FindOrAllocate(fixup.symbol, symbol_table, next_variable_address);
+    words[fixup.word_index] = static_cast<uint16_t>(n) & 0x7fff;
+  }
+  if (timed) {
+    stopwatch.Lap(stats.symbol_resolution_ns);
+  }
+
+  stats.variables = next_variable_address - kFirstVariableAddress;
+  return words;
+}
+
+// Encodes the instructions of an already parsed program.
+std::vector<uint16_t> EncodeInstructions(
+    const std::vector<Instruction>& program, SymbolTable& symbol_table,
+    const std::vector<Instruction>* variable_order, AssemblyStats& stats) {
+  Stopwatch stopwatch;
+  size_t address = 0;
+  for (const Instruction& instruction : program) {
+    if (instruction.instruction_type == InstructionType::kLInstruction) {
+      symbol_table.AddEntry(instruction.symbol, address);
+      stats.labels++;
+    } else {
+      address++;
+    }
+  }
+  stopwatch.Lap(stats.label_collection_ns);
+
+  int next_variable_address = kFirstVariableAddress;
+  if (variable_order != nullptr) {
+    // Labels of code that a pass removed are in `variable_order` but not in
+    // `program`; references to them are not variables.
+    std::unordered_set<std::string_view> labels;
+    for (const Instruction& instruction : *variable_order) {
+      if (instruction.instruction_type == InstructionType::kLInstruction) {
+        labels.insert(instruction.symbol);
+      }
+    }
+    for (const Instruction& instruction : *variable_order) {
+      if (instruction.instruction_type == InstructionType::kAInstruction &&
+          labels.count(instruction.symbol) == 0) {
+        FindOrAllocate(instruction.symbol, symbol_table, next_variable_address);
+      }
+    }
+  }
+
+  std::vector<uint16_t> words;
+  words.reserve(address);
+  for (const Instruction& instruction : program) {
+    switch (instruction.instruction_type) {
+      case InstructionType::kLInstruction:
+        break;
+
+      case InstructionType::kAInstruction: {
+        int n = FindOrAllocate(instruction.symbol, symbol_table,
+                               next_variable_address);
+        words.push_back(static_cast<uint16_t>(n) & 0x7fff);
+        break;
+      }
+
+      case InstructionType::kCInstruction:
+        words.push_back(EncodeCInstruction(instruction.destination,
+                                           instruction.comparison,
+                                           instruction.jump));
+        break;
+    }
+  }
+  stopwatch.Lap(stats.symbol_resolution_ns);
+
+  stats.variables = next_variable_address - kFirstVariableAddress;
+  return words;
+}
+
+// Fills in the counts that can be read off the finished result.
+void CountResult(AssemblyResult& result) {
+  size_t a_instructions =
+      std::count_if(result.words.begin(), result.words.end(),
+                    [](uint16_t word) { return (word & 0x8000) == 0; });
+  result.stats.a_instructions = a_instructions;
+  result.stats.c_instructions = result.words.size() - a_instructions;
+  result.stats.symbols = result.symbols.size();
+}
+
+}  // namespace
+
+AssemblyResult AssembleInstructions(
+    const std::vector<Instruction>& program,
+    const std::vector<Instruction>* variable_order) {
+  AssemblyResult result;
+  result.words = EncodeInstructions(program, result.symbols, variable_order,
+                                    result.stats);
+  CountResult(result);
+  return result;
+}
+
+AssemblyResult Assemble(std::string_view source,
+                        const AssemblyOptions& options) {
+  if (options.simplify_control_flow || options.peephole ||
+      options.outline || options.keep_program) {
+    Stopwatch stopwatch;
+    AssemblyStats stats;
+    const std::vector<Instruction> original = ParseAll(source);
+    std::vector<Instruction> program = original;
+    stopwatch.Lap(stats.parsing_ns);
+    ControlFlowStats control_flow_stats;
+    if (options.simplify_control_flow) {
+      control_flow_stats = SimplifyControlFlow(program);
+    }
+    PeepholeStats peephole_stats;
+    if (options.peephole) {
+      peephole_stats = OptimizePeephole(program);
+    }
+    std::deque<std::string> outlined_names;
+    OutlineStats outline_stats;
+    if (options.outline) {
+      outline_stats = OutlineRepeatedSequences(program, outlined_names,
+                                               options.outline_options);
+    }
+    stopwatch.Lap(stats.optimization_ns);
+    AssemblyResult result = AssembleInstructions(program, &original);
+    result.stats.parsing_ns = stats.parsing_ns;
+    result.stats.optimization_ns = stats.optimization_ns;
+    result.stats.bytes_read = source.size();
+    if (options.keep_program) {
+      result.program = std::move(program);
+      result.outlined_names = std::move(outlined_names);
+    }
+    result.control_flow_stats = control_flow_stats;
+    result.peephole_stats = std::move(peephole_stats);
+    result.outline_stats = outline_stats;
+    return result;
+  }
+
+  AssemblyResult result;
+  result.stats.bytes_read = source.size();
+  if (options.num_threads > 1) {
+    result.words = AssembleParallel(source, options.num_threads,
+                                    kDefaultMinChunkSize, &result.symbols,
+                                    &result.stats);
+  } else {
+    // Every label definition contains a '(', so this bounds the label count.
+    result.symbols.Reserve(std::count(source.begin(), source.end(), '('));
+    if (options.single_pass) {
+      result.words = AssembleSinglePass(source, result.symbols,
+                                        options.collect_stats, result.stats);
+    } else {
+      result.words = AssembleTwoPass(source, result.symbols,
+                                     options.collect_stats, result.stats);
+    }
+  }
+  CountResult(result);
+  return result;
+}
+
+}  // namespace hack
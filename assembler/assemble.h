@@ -0,0 +1,96 @@
+#ifndef ASSEMBLER_ASSEMBLE_H_
+#define ASSEMBLER_ASSEMBLE_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "assembler/assembly_stats.h"
+#include "assembler/control_flow.h"
+#include "assembler/outline.h"
+#include "assembler/parser.h"
+#include "assembler/peephole.h"
+#include "assembler/symbol_table.h"
+
+namespace hack {
+
+struct AssemblyOptions {
+  // Tokenize the source once, backpatching forward references, rather than
+  // making a separate pass to collect labels. Output is the same either way.
+  bool single_pass = false;
+
+  // Assemble on this many threads. See AssembleParallel.
+  int num_threads = 1;
+
+  // Thread jump chains and drop unreachable code before any other
+  // optimization. Simplified programs are always assembled on one thread.
+  bool simplify_control_flow = false;
+
+  // Run the peephole optimizer over the parsed program before encoding it.
+  // Optimized programs are always assembled on one thread.
+  bool peephole = false;
+
+  // Outline repeated sequences into subroutines to shrink the program, after
+  // the peephole optimizer if both are enabled. Outlined programs are always
+  // assembled on one thread.
+  bool outline = false;
+
+  OutlineOptions outline_options;
+
+  // Keep the parsed, and possibly optimized, program in AssemblyResult, e.g.
+  // to write a listing. The program is then always parsed once and assembled
+  // from the parsed instructions, on one thread.
+  bool keep_program = false;
+
+  // Record how long each phase of serial assembly takes in
+  // AssemblyResult::stats. The serial assemblers then parse, resolve and
+  // encode a block of instructions at a time rather than interleaving them,
+  // which costs a few percent. Counts and the times of other modes are always
+  // recorded.
+  bool collect_stats = false;
+};
+
+struct AssemblyResult {
+  // The encoded program, one word per instruction.
+  std::vector<uint16_t> words;
+
+  // Every predefined symbol, label and variable with its final address.
+  SymbolTable symbols = SymbolTable::Create();
+
+  // What control flow simplification did, if it ran.
+  ControlFlowStats control_flow_stats;
+
+  // What the peephole optimizer did, if it ran.
+  PeepholeStats peephole_stats;
+
+  // What outlining did, if it ran.
+  OutlineStats outline_stats;
+
+  // The program as assembled, if AssemblyOptions::keep_program was set. Its
+  // symbols are views into the source or into `outlined_names`.
+  std::vector<Instruction> program;
+
+  // Names of subroutines added by outlining.
+  std::deque<std::string> outlined_names;
+
+  // Phase times and counts. The output fields are left for the caller.
+  AssemblyStats stats;
+};
+
+// Assembles Hack assembly `source` in-process.
+AssemblyResult Assemble(std::string_view source,
+                        const AssemblyOptions& options = {});
+
+// Assembles an already parsed program, e.g. one that has been rewritten by an
+// optimization pass. If `variable_order` is given, variables are allocated in
+// order of first use there rather than in `program`, so that a rewritten
+// program keeps the variable addresses of the original.
+AssemblyResult AssembleInstructions(
+    const std::vector<Instruction>& program,
+    const std::vector<Instruction>* variable_order = nullptr);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_ASSEMBLE_H_
@@ -0,0 +1,206 @@
+#include "assembler/assemble.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hack {
+namespace {
+
+constexpr std::string_view kProgram = R"asm(
+// Forward and backward label references, variables and predefined symbols.
+@i
+M=1
+(LOOP)
+@i
+D=M
+@100
+D=D-A
+@END
+D;JGT
+@sum
+M=D+M
+@i
+M=M+1
+@LOOP
+0;JMP
+(END)
+@END
+0;JMP
+@KBD
+@j
+)asm";
+
+const std::vector<uint16_t> kExpected = {
+  16, 0xefc8, 16, 0xfc10, 100, 0xe4d0, 14, 0xe301, 17, 0xf088,
+  16, 0xfdc8, 2, 0xea87, 14, 0xea87, 24576, 18
+};
+
+std::map<std::string, int> SymbolMap(const SymbolTable& symbols) {
+  std::map<std::string, int> map;
+  symbols.ForEach([&](std::string_view symbol, int value) {
+    map[std::string(symbol)] = value;
+  });
+  return map;
+}
+
+TEST(AssembleTest, TwoPass) {
+  AssemblyResult result = Assemble(kProgram);
+
+  EXPECT_EQ(result.words, kExpected);
+}
+
+TEST(AssembleTest, SinglePass) {
+  AssemblyOptions options;
+  options.single_pass = true;
+
+  AssemblyResult result = Assemble(kProgram, options);
+
+  EXPECT_EQ(result.words, kExpected);
+}
+
+TEST(AssembleTest, CollectingStatsGivesTheSameOutput) {
+  AssemblyOptions options;
+  options.collect_stats = true;
+  AssemblyOptions single_pass = options;
+  single_pass.single_pass = true;
+
+  EXPECT_EQ(Assemble(kProgram, options).words, kExpected);
+  EXPECT_EQ(Assemble(kProgram, single_pass).words, kExpected);
+}
+
+TEST(AssembleTest, KeepsTheProgram) {
+  AssemblyOptions options;
+  options.keep_program = true;
+
+  AssemblyResult result = Assemble(kProgram, options);
+
+  EXPECT_EQ(result.words, kExpected);
+  ASSERT_EQ(result.program.size(), kExpected.size() + 2);
+  EXPECT_EQ(result.program[2].instruction_type, InstructionType::kLInstruction);
+  EXPECT_EQ(result.program[2].symbol, "LOOP");
+}
+
+TEST(AssembleTest, Parallel) {
+  AssemblyOptions options;
+  options.num_threads = 4;
+
+  AssemblyResult result = Assemble(kProgram, options);
+
+  EXPECT_EQ(result.words, kExpected);
+}
+
+TEST(AssembleTest, SymbolsIncludeLabelsAndVariables) {
+  AssemblyResult result = Assemble(kProgram);
+
+  std::map<std::string, int> symbols = SymbolMap(result.symbols);
+  EXPECT_EQ(symbols["LOOP"], 2);
+  EXPECT_EQ(symbols["END"], 14);
+  EXPECT_EQ(symbols["i"], 16);
+  EXPECT_EQ(symbols["sum"], 17);
+  EXPECT_EQ(symbols["j"], 18);
+  EXPECT_EQ(symbols["SCREEN"], 16384);
+}
+
+// Redefines a label after it has been used, and a predefined symbol.
+constexpr std::string_view kRedefinedLabels = R"asm(
+(L)
+@L
+0;JMP
+@SP
+M=1
+(L)
+@L
+0;JMP
+(SP)
+@SP
+@x
+)asm";
+
+TEST(AssembleTest, AllModesAgreeOnSymbols) {
+  AssemblyOptions single_pass;
+  single_pass.single_pass = true;
+  AssemblyOptions parallel;
+  parallel.num_threads = 3;
+
+  for (std::string_view source : {kProgram, kRedefinedLabels}) {
+    AssemblyResult expected = Assemble(source);
+    std::map<std::string, int> expected_symbols = SymbolMap(expected.symbols);
+
+    for (const AssemblyOptions& options : {single_pass, parallel}) {
+      AssemblyResult result = Assemble(source, options);
+      EXPECT_EQ(result.words, expected.words) << source;
+      EXPECT_EQ(SymbolMap(result.symbols), expected_symbols) << source;
+    }
+  }
+}
+
+TEST(AssembleTest, LaterLabelDefinitionsWin) {
+  AssemblyOptions single_pass;
+  single_pass.single_pass = true;
+
+  AssemblyResult result = Assemble(kRedefinedLabels, single_pass);
+
+  EXPECT_EQ(result.words, (std::vector<uint16_t>{
+                              4, 0xea87, 6, 0xefc8, 4, 0xea87, 6, 16}));
+}
+
+TEST(AssembleTest, SimplifyingControlFlowKeepsVariableAddresses) {
+  // The block at DEAD is unreachable. Its label goes with it, but the
+  // reference to DEAD is not a variable.
+  constexpr std::string_view kDeadBlock = R"asm(
+@x
+M=1
+@END
+0;JMP
+(DEAD)
+@DEAD
+0;JMP
+(END)
+@y
+M=1
+(HALT)
+@HALT
+0;JMP
+)asm";
+  AssemblyOptions options;
+  options.simplify_control_flow = true;
+
+  AssemblyResult result = Assemble(kDeadBlock, options);
+
+  EXPECT_EQ(result.control_flow_stats.blocks_removed, 1);
+  std::map<std::string, int> expected = SymbolMap(Assemble(kDeadBlock).symbols);
+  std::map<std::string, int> symbols = SymbolMap(result.symbols);
+  EXPECT_EQ(symbols["x"], expected["x"]);
+  EXPECT_EQ(symbols["y"], expected["y"]);
+  EXPECT_EQ(symbols["y"], 17);
+  EXPECT_EQ(result.stats.variables, 2);
+}
+
+TEST(AssembleTest, AllModesCountTheSameWork) {
+  AssemblyOptions single_pass;
+  single_pass.single_pass = true;
+  AssemblyOptions parallel;
+  parallel.num_threads = 3;
+  AssemblyOptions timed;
+  timed.collect_stats = true;
+  AssemblyOptions timed_single_pass = single_pass;
+  timed_single_pass.collect_stats = true;
+
+  for (const AssemblyOptions& options :
+       {AssemblyOptions(), single_pass, parallel, timed, timed_single_pass}) {
+    AssemblyResult result = Assemble(kProgram, options);
+
+    EXPECT_EQ(result.stats.a_instructions, 10);
+    EXPECT_EQ(result.stats.c_instructions, 8);
+    EXPECT_EQ(result.stats.labels, 2);
+    EXPECT_EQ(result.stats.variables, 3);
+    EXPECT_EQ(result.stats.symbols, result.symbols.size());
+    EXPECT_EQ(result.stats.bytes_read, kProgram.size());
+  }
+}
+
+}  // namespace
+}  // namespace hack
@@ -1,96 +1,439 @@
-#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdlib>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
 
-#include "assembler/code.h"
-#include "assembler/parser.h"
-#include "assembler/symbol_table.h"
-
-using ::hack::Instruction;
-using ::hack::InstructionType;
-using ::hack::Parser;
-using ::hack::SymbolTable;
-using ::hack::CompToBinary;
-using ::hack::DestToBinary;
-using ::hack::JumpToBinary;
-
-SymbolTable PopulateLabels(std::ifstream& input_stream) {
-  Parser parser(input_stream);
-
-  auto symbol_table = SymbolTable::Create();
-  int line_number = 0;
-  while (parser.HasMoreLines()) {
-    parser.Advance();
-    Instruction instruction = parser.CurrentInstruction();
-    if (instruction.instruction_type == InstructionType::kLInstruction) {
-      symbol_table.AddEntry(instruction.symbol, line_number + 1);
-    } else {
-      line_number++;
+#include "assembler/assemble.h"
+#include "assembler/assembly_cache.h"
+#include "assembler/listing.h"
+#include "assembler/object_file.h"
+#include "assembler/parallel_assembler.h"
+#include "assembler/pipelined_assembler.h"
+#include "assembler/rom_image.h"
+#include "util/io/mapped_file.h"
+#include "util/io/output_sink.h"
+
+using ::hack::Assemble;
+using ::hack::AssemblyOptions;
+using ::hack::AssemblyResult;
+using ::hack::AssemblePipelined;
+using ::hack::AssemblyStats;
+using ::hack::AssembleObject;
+using ::hack::AssemblyCache;
+using ::hack::Stopwatch;
+using ::hack::WriteObjectFile;
+using ::hack::WriteHackText;
+using ::hack::WriteHackTextParallel;
+using ::hack::WriteListing;
+using ::hack::WriteRomImage;
+using ::hack::WriteStatsJson;
+using ::util_io::MappedFile;
+using ::util_io::OutputSink;
+
+enum class OutputFormat {
+  // One line of 16 '0'/'1' characters per word.
+  kText,
+
+  // A packed ROM image.
+  kBinary,
+
+  // A relocatable object file for the linker.
+  kObject
+};
+
+// Names each format in cache keys.
+constexpr std::string_view kOutputFormatNames[] = {"text", "binary", "object"};
+
+// Environment variable naming a cache directory, as an alternative to
+// --cache_dir.
+constexpr char kCacheDirEnvironmentVariable[] = "HACK_ASSEMBLER_CACHE_DIR";
+
+// Environment variable that turns on --stats when set to anything but "0".
+constexpr char kStatsEnvironmentVariable[] = "HACK_ASSEMBLER_STATS";
+
+// Names everything besides the source that changes the output.
+std::string CacheVariant(const AssemblyOptions& options, OutputFormat format) {
+  std::string variant(kOutputFormatNames[static_cast<int>(format)]);
+  if (format == OutputFormat::kObject) {
+    return variant;
+  }
+  if (options.simplify_control_flow) {
+    variant += "+cfg";
+  }
+  if (options.peephole) {
+    variant += "+peephole";
+  }
+  if (options.outline) {
+    variant += "+outline=" +
+        std::to_string(options.outline_options.min_words_saved);
+  }
+  return variant;
+}
+
+// Prints what the optimization passes did to stderr.
+void ReportOptimizations(const AssemblyOptions& options,
+                         const AssemblyResult& result) {
+  if (options.simplify_control_flow) {
+    const hack::ControlFlowStats& stats = result.control_flow_stats;
+    std::cerr << "Threaded " << stats.jumps_threaded << " jumps and removed "
+              << stats.blocks_removed << " unreachable blocks ("
+              << stats.instructions_removed << " instructions)" << std::endl;
+  }
+  if (options.peephole) {
+    std::cerr << "Peephole optimizer removed "
+              << result.peephole_stats.instructions_removed
+              << " instructions" << std::endl;
+    for (const auto& [rule, count] : result.peephole_stats.rule_counts) {
+      std::cerr << "  " << rule << ": " << count << std::endl;
     }
   }
+  if (options.outline) {
+    const hack::OutlineStats& stats = result.outline_stats;
+    std::cerr << "Outlined " << stats.call_sites << " sequences into "
+              << stats.subroutines << " subroutines, saving "
+              << stats.bytes_saved() << " bytes (" << stats.words_saved
+              << " words) for " << stats.cycles_added
+              << " extra cycles if each call runs once" << std::endl;
+  }
+}
+
+// Files to write each output format to, so that one run can produce several.
+struct OutputFiles {
+  std::optional<std::string> text;
 
-  return symbol_table;
+  std::optional<std::string> binary;
+
+  std::optional<std::string> listing;
+
+  bool empty() const {
+    return !text && !binary && !listing;
+  }
+};
+
+// Writes one output file through its own sink, "-" meaning stdout. Returns
+// false after reporting any error.
+template <typename WriteFn>
+bool WriteOutputFile(const std::string& path, size_t& bytes_written,
+                     const WriteFn& write) {
+  int fd = STDOUT_FILENO;
+  if (path != "-") {
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      std::cerr << "Could not open '" << path << "' for writing" << std::endl;
+      return false;
+    }
+  }
+  bool ok;
+  {
+    OutputSink sink(fd);
+    write(sink);
+    ok = sink.Flush();
+    bytes_written += sink.bytes_written();
+  }
+  if (fd != STDOUT_FILENO && close(fd) != 0) {
+    ok = false;
+  }
+  if (!ok) {
+    std::cerr << "Could not write '" << path << "'" << std::endl;
+  }
+  return ok;
 }
 
-int main(int argc, char* argv[]) {
-  if (argc != 2) {
-    std::cerr << "Usage: assembler <file>" << std::endl;
-    return 1;
+// Assembles `source` once and writes each of `files`, then `stats` as JSON on
+// stderr if it is not null. Returns the exit code.
+int WriteOutputFiles(std::string_view source, AssemblyOptions options,
+                     const OutputFiles& files, AssemblyStats* stats) {
+  options.keep_program = files.listing.has_value();
+  AssemblyResult result = Assemble(source, options);
+  Stopwatch stopwatch;
+  ReportOptimizations(options, result);
+  size_t bytes_written = 0;
+  bool ok = true;
+  if (files.text) {
+    ok &= WriteOutputFile(*files.text, bytes_written, [&](OutputSink& sink) {
+      if (options.num_threads > 1) {
+        WriteHackTextParallel(result.words, sink, options.num_threads);
+      } else {
+        WriteHackText(result.words, sink);
+      }
+    });
+  }
+  if (files.binary) {
+    ok &= WriteOutputFile(*files.binary, bytes_written, [&](OutputSink& sink) {
+      std::ostringstream image;
+      WriteRomImage(result.words, image);
+      sink.Write(image.str());
+    });
   }
+  if (files.listing) {
+    ok &= WriteOutputFile(*files.listing, bytes_written, [&](OutputSink& sink) {
+      WriteListing(result.program, result.words, result.symbols, sink);
+    });
+  }
+  if (stats != nullptr) {
+    *stats = result.stats;
+    stopwatch.Lap(stats->output_ns);
+    stats->bytes_written = bytes_written;
+    WriteStatsJson(*stats, std::cerr);
+  }
+  return ok ? 0 : 3;
+}
 
-  std::filesystem::path absolute_path = std::filesystem::absolute(argv[1]);
-  std::ifstream input_stream(absolute_path.string());
-  if (!input_stream.is_open()) {
-    std::cerr << "Could not open '" << absolute_path << "'" << std::endl;
-    return 2;
+// Assembles `source` into `output`. If `stats` is not null, fills it in, but
+// for the bytes written, which only the caller knows.
+void WriteOutput(std::string_view source, const AssemblyOptions& options,
+                 OutputFormat format, OutputSink& output,
+                 AssemblyStats* stats) {
+  if (format == OutputFormat::kObject) {
+    Stopwatch stopwatch;
+    std::ostringstream object;
+    WriteObjectFile(AssembleObject(source), object);
+    output.Write(object.str());
+    if (stats != nullptr) {
+      stopwatch.Lap(stats->output_ns);
+      stats->bytes_read = source.size();
+    }
+    return;
   }
 
-  auto symbol_table = PopulateLabels(input_stream);
+  AssemblyResult result = Assemble(source, options);
+  Stopwatch stopwatch;
+  ReportOptimizations(options, result);
+  if (format == OutputFormat::kBinary) {
+    std::ostringstream image;
+    WriteRomImage(result.words, image);
+    output.Write(image.str());
+  } else if (options.num_threads > 1) {
+    WriteHackTextParallel(result.words, output, options.num_threads);
+  } else {
+    WriteHackText(result.words, output);
+  }
+  if (stats != nullptr) {
+    *stats = result.stats;
+    stopwatch.Lap(stats->output_ns);
+  }
+}
 
-  input_stream.clear();
-  input_stream.seekg(0);
-  Parser parser(input_stream);
+// Whether --pipeline can apply. The pipeline streams its input, so it cannot
+// compute a cache key up front, and it only does plain text assembly.
+bool CanPipeline(const AssemblyOptions& options, OutputFormat format,
+                 bool use_cache, const OutputFiles& files) {
+  return format == OutputFormat::kText && !use_cache && files.empty() &&
+      options.num_threads <= 1 && !options.simplify_control_flow &&
+      !options.peephole && !options.outline;
+}
 
-  int next_variable_address = 16;
-  while (parser.HasMoreLines()) {
-    parser.Advance();
-    Instruction instruction = parser.CurrentInstruction();
-    InstructionType instruction_type = instruction.instruction_type;
+// Writes out everything still buffered in `output`, then `stats` as JSON on
+// stderr if it is not null. Returns the exit code.
+int FlushOutput(OutputSink& output, AssemblyStats* stats) {
+  Stopwatch stopwatch;
+  bool ok = output.Flush();
+  if (stats != nullptr) {
+    stopwatch.Lap(stats->output_ns);
+    stats->bytes_written = output.bytes_written();
+    WriteStatsJson(*stats, std::cerr);
+  }
+  if (!ok) {
+    std::cerr << "Could not write output" << std::endl;
+    return 3;
+  }
+  return 0;
+}
 
-    if (instruction_type == InstructionType::kLInstruction) {
-      // Ignore pseudo-instruction.
-      continue;
+int main(int argc, char* argv[]) {
+  AssemblyOptions options;
+  OutputFormat format = OutputFormat::kText;
+  std::optional<std::string> cache_dir;
+  if (const char* env_cache_dir = getenv(kCacheDirEnvironmentVariable)) {
+    cache_dir = env_cache_dir;
+  }
+  bool print_cache_stats = false;
+  bool pipeline = false;
+  OutputFiles output_files;
+  std::optional<AssemblyStats> stats;
+  if (const char* env_stats = getenv(kStatsEnvironmentVariable)) {
+    if (std::string_view(env_stats) != "0") {
+      stats.emplace();
+    }
+  }
+  std::optional<std::string> input_path;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg == "--single_pass") {
+      options.single_pass = true;
+    } else if (arg == "--simplify_cfg") {
+      options.simplify_control_flow = true;
+    } else if (arg == "--peephole") {
+      options.peephole = true;
+    } else if (arg == "--outline") {
+      options.outline = true;
+    } else if (arg.substr(0, 21) == "--outline_min_saving=") {
+      options.outline = true;
+      options.outline_options.min_words_saved = std::atoi(argv[i] + 21);
+    } else if (arg == "--stats") {
+      stats.emplace();
+    } else if (arg == "--pipeline") {
+      pipeline = true;
+    } else if (arg.substr(0, 11) == "--text_out=") {
+      output_files.text = std::string(arg.substr(11));
+    } else if (arg.substr(0, 13) == "--binary_out=") {
+      output_files.binary = std::string(arg.substr(13));
+    } else if (arg.substr(0, 14) == "--listing_out=") {
+      output_files.listing = std::string(arg.substr(14));
+    } else if (arg == "--format=text") {
+      format = OutputFormat::kText;
+    } else if (arg == "--format=binary") {
+      format = OutputFormat::kBinary;
+    } else if (arg == "--format=object") {
+      format = OutputFormat::kObject;
+    } else if (arg.substr(0, 12) == "--cache_dir=") {
+      cache_dir = std::string(arg.substr(12));
+    } else if (arg == "--cache_stats") {
+      print_cache_stats = true;
+    } else if (arg.substr(0, 10) == "--threads=") {
+      options.num_threads = std::atoi(argv[i] + 10);
+      if (options.num_threads == 0) {
+        options.num_threads = std::thread::hardware_concurrency();
+      }
+    } else if (!input_path) {
+      input_path = arg;
+    } else {
+      input_path.reset();
+      break;
     }
+  }
+  options.collect_stats = stats.has_value();
+  if (!input_path) {
+    std::cerr << "Usage: assembler [--single_pass] [--simplify_cfg] "
+              << "[--peephole] [--outline] [--outline_min_saving=N] "
+              << "[--format=text|binary|object] "
+              << "[--text_out=FILE] [--binary_out=FILE] [--listing_out=FILE] "
+              << "[--threads=N] [--pipeline] [--cache_dir=DIR [--cache_stats]] "
+              << "[--stats] <file>"
+              << std::endl
+              << "  Pass '-' as the file to read from stdin." << std::endl
+              << "  --format=binary writes a packed ROM image; convert it back "
+              << "to text with rom_to_hack." << std::endl
+              << "  --format=object writes a relocatable module for the linker."
+              << std::endl
+              << "  --text_out, --binary_out and --listing_out write any of "
+              << "those outputs from a" << std::endl
+              << "    single assembly instead of writing --format to stdout. "
+              << "The listing shows" << std::endl
+              << "    addresses, words, resolved symbols and the symbol table."
+              << std::endl
+              << "  --simplify_cfg threads jump chains and removes unreachable "
+              << "code." << std::endl
+              << "  --peephole removes redundant instructions and reports how "
+              << "many." << std::endl
+              << "  --outline moves repeated sequences into subroutines "
+              << "using R14, and reports the size saved and cycles added."
+              << std::endl
+              << "  --outline_min_saving=N only outlines a sequence if that "
+              << "saves at least N words." << std::endl
+              << "  --threads=N assembles on N threads (0 for one per core)."
+              << std::endl
+              << "  --pipeline reads, encodes and writes on separate threads "
+              << "(text output only, ignored with other options)." << std::endl
+              << "  --cache_dir=DIR reuses output for previously seen inputs "
+              << "(or set " << kCacheDirEnvironmentVariable << ")." << std::endl
+              << "  --cache_stats prints the cache's hit and miss counts to "
+              << "stderr." << std::endl
+              << "  --stats prints phase timings and counts to stderr as JSON "
+              << "(or set " << kStatsEnvironmentVariable << "=1)." << std::endl;
+    return 1;
+  }
 
-    if (instruction_type == InstructionType::kAInstruction) {
-      std::string& symbol = instruction.symbol;
-      int n;
-      if (isdigit(symbol[0])) {
-	n = std::atoi(symbol.c_str());
-      } else if (symbol_table.Contains(symbol)) {
-        n = symbol_table.Get(symbol);
-      } else {
-	// need to make new symbol - it's a variable.
-	n = next_variable_address++;
-	symbol_table.AddEntry(symbol, n);
+  if (pipeline &&
+      CanPipeline(options, format, cache_dir.has_value(), output_files)) {
+    int fd = STDIN_FILENO;
+    if (*input_path != "-") {
+      fd = open(input_path->c_str(), O_RDONLY);
+      if (fd < 0) {
+        std::cerr << "Could not open '" << *input_path << "'" << std::endl;
+        return 2;
       }
-      // If we were error-handling we'd check that n was less than max int.
-      
-      std::bitset<16> binary(n);
-      // This bit signifies it's an A-instruction.
-      binary[15] = 0;
-      std::cout << binary.to_string() << std::endl;
-      continue;
     }
+    OutputSink stdout_sink(STDOUT_FILENO);
+    Stopwatch stopwatch;
+    bool read_ok = AssemblePipelined(fd, stdout_sink, {},
+                                     stats ? &*stats : nullptr);
+    if (stats) {
+      // The stages overlap, so the whole run counts as output.
+      stopwatch.Lap(stats->output_ns);
+    }
+    if (fd != STDIN_FILENO) {
+      close(fd);
+    }
+    if (!read_ok) {
+      std::cerr << "Could not read '" << *input_path << "'" << std::endl;
+      return 2;
+    }
+    return FlushOutput(stdout_sink, stats ? &*stats : nullptr);
+  }
 
-    // Must be C instruction.
-    std::cout << "111"
-	      << CompToBinary(instruction.comparison)
-	      << DestToBinary(instruction.destination)
-	      << JumpToBinary(instruction.jump)
-	      << std::endl;
+  std::optional<MappedFile> input_file;
+  if (*input_path == "-") {
+    // stdin may be a pipe straight out of the translator; it can only be read
+    // once, so always assemble it in a single pass.
+    input_file = MappedFile::FromFileDescriptor(STDIN_FILENO);
+    options.single_pass = true;
+  } else {
+    std::filesystem::path absolute_path = std::filesystem::absolute(*input_path);
+    input_file = MappedFile::Open(absolute_path.string());
+    if (!input_file) {
+      std::cerr << "Could not open '" << absolute_path << "'" << std::endl;
+      return 2;
+    }
   }
-  
-  return 0;
+  if (!input_file) {
+    std::cerr << "Could not read from stdin" << std::endl;
+    return 2;
+  }
+
+  std::string_view source = input_file->contents();
+  if (!output_files.empty()) {
+    return WriteOutputFiles(source, options, output_files,
+                            stats ? &*stats : nullptr);
+  }
+  OutputSink stdout_sink(STDOUT_FILENO);
+  if (!cache_dir) {
+    WriteOutput(source, options, format, stdout_sink,
+                stats ? &*stats : nullptr);
+    return FlushOutput(stdout_sink, stats ? &*stats : nullptr);
+  }
+
+  AssemblyCache cache(*cache_dir);
+  std::string key = AssemblyCache::Key(source, CacheVariant(options, format));
+  std::optional<std::string> output = cache.Lookup(key);
+  if (!output) {
+    std::ostringstream output_stream;
+    {
+      OutputSink sink(output_stream);
+      WriteOutput(source, options, format, sink, stats ? &*stats : nullptr);
+    }
+    output = output_stream.str();
+    if (!cache.Store(key, *output)) {
+      std::cerr << "Could not write to cache in '" << *cache_dir << "'"
+                << std::endl;
+    }
+  }
+  stdout_sink.Write(*output);
+  if (print_cache_stats) {
+    std::cerr << "Assembly cache: " << cache.hits() << " hits, "
+              << cache.misses() << " misses" << std::endl;
+  }
+
+  if (stats) {
+    stats->bytes_read = source.size();
+  }
+  return FlushOutput(stdout_sink, stats ? &*stats : nullptr);
 }
@@ -0,0 +1,177 @@
+// Benchmarks for the assembler's parser, encoders, symbol table and end-to-end
+// assembly, run over translator-style programs from GenerateTranslatedProgram.
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "assembler/assemble.h"
+#include "assembler/benchmark_corpus.h"
+#include "assembler/code.h"
+#include "assembler/parser.h"
+#include "assembler/symbol_table.h"
+
+namespace hack {
+namespace {
+
+// Returns the generated program with at least `num_instructions`
+// instructions, generating each size once.
+const std::string& Program(int num_instructions) {
+  static auto* programs = new std::vector<std::pair<int, std::string>>();
+  for (const auto& [size, program] : *programs) {
+    if (size == num_instructions) {
+      return program;
+    }
+  }
+  programs->emplace_back(num_instructions,
+                         GenerateTranslatedProgram(num_instructions));
+  return programs->back().second;
+}
+
+// Reports throughput in instructions and source bytes.
+void SetProcessed(benchmark::State& state, std::string_view source,
+                  int num_instructions) {
+  state.SetItemsProcessed(state.iterations() * num_instructions);
+  state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+void BM_ParserAdvance(benchmark::State& state) {
+  const std::string& source = Program(state.range(0));
+  int num_instructions = 0;
+  for (auto _ : state) {
+    Parser parser{std::string_view(source)};
+    num_instructions = 0;
+    while (parser.HasMoreLines()) {
+      parser.Advance();
+      benchmark::DoNotOptimize(parser.CurrentInstruction());
+      num_instructions++;
+    }
+  }
+  SetProcessed(state, source, num_instructions);
+}
+BENCHMARK(BM_ParserAdvance)->Arg(100000);
+
+// The mnemonics of every C-instruction in a generated program, in order.
+struct Mnemonics {
+  std::vector<std::string_view> dests;
+  std::vector<std::string_view> comps;
+  std::vector<std::string_view> jumps;
+};
+
+const Mnemonics& ProgramMnemonics() {
+  static const Mnemonics* mnemonics = [] {
+    auto* mnemonics = new Mnemonics();
+    for (const Instruction& instruction : ParseAll(Program(100000))) {
+      if (instruction.instruction_type == InstructionType::kCInstruction) {
+        mnemonics->dests.push_back(instruction.destination);
+        mnemonics->comps.push_back(instruction.comparison);
+        mnemonics->jumps.push_back(instruction.jump);
+      }
+    }
+    return mnemonics;
+  }();
+  return *mnemonics;
+}
+
+template <uint16_t (*Encode)(std::string_view)>
+void EncodeAll(benchmark::State& state,
+               const std::vector<std::string_view>& mnemonics) {
+  for (auto _ : state) {
+    for (std::string_view mnemonic : mnemonics) {
+      benchmark::DoNotOptimize(Encode(mnemonic));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * mnemonics.size());
+}
+
+void BM_EncodeDest(benchmark::State& state) {
+  EncodeAll<EncodeDest>(state, ProgramMnemonics().dests);
+}
+BENCHMARK(BM_EncodeDest);
+
+void BM_EncodeComp(benchmark::State& state) {
+  EncodeAll<EncodeComp>(state, ProgramMnemonics().comps);
+}
+BENCHMARK(BM_EncodeComp);
+
+void BM_EncodeJump(benchmark::State& state) {
+  EncodeAll<EncodeJump>(state, ProgramMnemonics().jumps);
+}
+BENCHMARK(BM_EncodeJump);
+
+// Symbols shaped like the translator's labels and statics.
+std::vector<std::string> MakeSymbols(int n) {
+  std::vector<std::string> symbols;
+  symbols.reserve(n);
+  for (int i = 0; i < n; i++) {
+    symbols.push_back("Main.f" + std::to_string(i / 8) + "$L" +
+                      std::to_string(i % 8));
+  }
+  return symbols;
+}
+
+void BM_SymbolTableInsert(benchmark::State& state) {
+  std::vector<std::string> symbols = MakeSymbols(state.range(0));
+  for (auto _ : state) {
+    SymbolTable table = SymbolTable::Create();
+    for (size_t i = 0; i < symbols.size(); i++) {
+      table.AddEntry(symbols[i], i);
+    }
+    benchmark::DoNotOptimize(table.size());
+  }
+  state.SetItemsProcessed(state.iterations() * symbols.size());
+}
+BENCHMARK(BM_SymbolTableInsert)->Arg(100)->Arg(10000)->Arg(1000000);
+
+void BM_SymbolTableLookup(benchmark::State& state) {
+  std::vector<std::string> symbols = MakeSymbols(state.range(0));
+  SymbolTable table = SymbolTable::Create();
+  for (size_t i = 0; i < symbols.size(); i++) {
+    table.AddEntry(symbols[i], i);
+  }
+  for (auto _ : state) {
+    for (const std::string& symbol : symbols) {
+      benchmark::DoNotOptimize(table.Get(symbol));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * symbols.size());
+}
+BENCHMARK(BM_SymbolTableLookup)->Arg(100)->Arg(10000)->Arg(1000000);
+
+AssemblyOptions SinglePassOptions() {
+  AssemblyOptions options;
+  options.single_pass = true;
+  return options;
+}
+
+AssemblyOptions ThreadedOptions(int num_threads) {
+  AssemblyOptions options;
+  options.num_threads = num_threads;
+  return options;
+}
+
+void BM_Assemble(benchmark::State& state, AssemblyOptions options) {
+  const std::string& source = Program(state.range(0));
+  size_t num_words = 0;
+  for (auto _ : state) {
+    AssemblyResult result = Assemble(source, options);
+    num_words = result.words.size();
+    benchmark::DoNotOptimize(result.words.data());
+  }
+  SetProcessed(state, source, num_words);
+}
+BENCHMARK_CAPTURE(BM_Assemble, two_pass, AssemblyOptions{})
+    ->Arg(10000)->Arg(100000)->Arg(1000000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Assemble, single_pass, SinglePassOptions())
+    ->Arg(10000)->Arg(100000)->Arg(1000000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Assemble, four_threads, ThreadedOptions(4))
+    ->Arg(10000)->Arg(100000)->Arg(1000000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace hack
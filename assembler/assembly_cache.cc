@@ -0,0 +1,159 @@
+#include "assembler/assembly_cache.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+namespace hack {
+
+// Holds the hit and miss counts as two native-endian 64-bit integers.
+constexpr char kCountsFileName[] = "counts";
+constexpr off_t kHitsOffset = 0;
+constexpr off_t kMissesOffset = sizeof(uint64_t);
+constexpr char kEntryExtension[] = ".out";
+
+constexpr uint64_t kMultiplier1 = 0x9e3779b97f4a7c15ull;
+constexpr uint64_t kMultiplier2 = 0xc2b2ae3d27d4eb4full;
+
+namespace {
+
+uint64_t Mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= kMultiplier2;
+  h ^= h >> 29;
+  h *= kMultiplier1;
+  h ^= h >> 32;
+  return h;
+}
+
+// Hashes `data` eight bytes at a time.
+uint64_t Hash64(std::string_view data, uint64_t seed) {
+  uint64_t h = seed ^ (data.size() * kMultiplier1);
+  size_t i = 0;
+  for (; i + 8 <= data.size(); i += 8) {
+    uint64_t word;
+    memcpy(&word, data.data() + i, sizeof(word));
+    h = (h ^ Mix(word)) * kMultiplier2;
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, data.data() + i, data.size() - i);
+  h = (h ^ Mix(tail)) * kMultiplier2;
+  return Mix(h);
+}
+
+void AppendHex(std::string& out, uint64_t value) {
+  char hex[17];
+  snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(value));
+  out.append(hex);
+}
+
+}  // namespace
+
+AssemblyCache::AssemblyCache(std::filesystem::path directory) :
+    directory_(std::move(directory)) {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+}
+
+std::string AssemblyCache::Key(std::string_view source,
+                               std::string_view variant) {
+  std::string salt = std::string(kAssemblerVersion) + "/" +
+      std::string(variant);
+  uint64_t seed = Hash64(salt, 0);
+  // Two independently seeded 64-bit hashes make accidental collisions between
+  // distinct inputs vanishingly unlikely.
+  std::string key;
+  AppendHex(key, Hash64(source, seed));
+  AppendHex(key, Hash64(source, ~seed));
+  return key;
+}
+
+std::optional<std::string> AssemblyCache::Lookup(const std::string& key) {
+  std::ifstream input(directory_ / (key + kEntryExtension), std::ios::binary);
+  if (!input.is_open()) {
+    Record(kMissesOffset);
+    return {};
+  }
+  std::string output((std::istreambuf_iterator<char>(input)),
+                     std::istreambuf_iterator<char>());
+  Record(kHitsOffset);
+  return output;
+}
+
+bool AssemblyCache::Store(const std::string& key, std::string_view output) {
+  static std::atomic<int> next_temporary(0);
+  std::filesystem::path temporary_path = directory_ /
+      (key + ".tmp." + std::to_string(getpid()) + "." +
+       std::to_string(next_temporary++));
+  {
+    std::ofstream temporary(temporary_path, std::ios::binary);
+    if (!temporary.write(output.data(), output.size()) || !temporary.flush()) {
+      std::filesystem::remove(temporary_path);
+      return false;
+    }
+  }
+
+  // rename() replaces any existing entry atomically. Concurrent writers of the
+  // same key produce identical contents, so it does not matter which wins.
+  std::error_code error;
+  std::filesystem::rename(temporary_path, directory_ / (key + kEntryExtension),
+                          error);
+  if (error) {
+    std::filesystem::remove(temporary_path, error);
+    return false;
+  }
+  return true;
+}
+
+uint64_t AssemblyCache::hits() const {
+  return Count(kHitsOffset);
+}
+
+uint64_t AssemblyCache::misses() const {
+  return Count(kMissesOffset);
+}
+
+void AssemblyCache::Record(off_t offset) {
+  // The exclusive lock makes the read and write one step, so concurrent
+  // processes never lose a count.
+  int fd = open((directory_ / kCountsFileName).c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    return;
+  }
+  if (flock(fd, LOCK_EX) == 0) {
+    // A counter that has never been written reads short and counts as zero.
+    uint64_t count = 0;
+    if (pread(fd, &count, sizeof(count), offset) != sizeof(count)) {
+      count = 0;
+    }
+    count++;
+    if (pwrite(fd, &count, sizeof(count), offset) != sizeof(count)) {
+      // Counts are best effort.
+    }
+  }
+  close(fd);
+}
+
+uint64_t AssemblyCache::Count(off_t offset) const {
+  int fd = open((directory_ / kCountsFileName).c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  uint64_t count = 0;
+  if (flock(fd, LOCK_SH) != 0 ||
+      pread(fd, &count, sizeof(count), offset) != sizeof(count)) {
+    count = 0;
+  }
+  close(fd);
+  return count;
+}
+
+}  // namespace hack
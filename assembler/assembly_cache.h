@@ -0,0 +1,56 @@
+#ifndef ASSEMBLER_ASSEMBLY_CACHE_H_
+#define ASSEMBLER_ASSEMBLY_CACHE_H_
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace hack {
+
+// Identifies the assembler's output for a given input. Bump this whenever a
+// change could make the assembler produce different output for the same input,
+// so that stale cache entries are never returned.
+constexpr std::string_view kAssemblerVersion = "hack-assembler-1";
+
+// An on-disk cache of assembler output keyed by a hash of the input bytes.
+//
+// Several processes may share one cache directory: entries are written to a
+// temporary file and renamed into place, so a reader sees either a complete
+// entry or none. Hit and miss counts are kept in the directory too, in one
+// fixed-size file that each process updates in place under flock().
+class AssemblyCache final {
+ public:
+  explicit AssemblyCache(std::filesystem::path directory);
+
+  // Returns the cache key for `source`. `variant` distinguishes outputs that
+  // differ for the same source, e.g. the output format.
+  static std::string Key(std::string_view source, std::string_view variant);
+
+  // Returns the output stored under `key`, recording a hit or a miss.
+  std::optional<std::string> Lookup(const std::string& key);
+
+  // Stores `output` under `key`. Returns false if it could not be written.
+  bool Store(const std::string& key, std::string_view output);
+
+  // The number of hits and misses recorded in this cache directory by every
+  // process that has used it.
+  uint64_t hits() const;
+
+  uint64_t misses() const;
+
+ private:
+  // Adds one to the counter at `offset` in the counts file.
+  void Record(off_t offset);
+
+  uint64_t Count(off_t offset) const;
+
+  std::filesystem::path directory_;
+};
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_ASSEMBLY_CACHE_H_
@@ -0,0 +1,108 @@
+#include "assembler/assembly_cache.h"
+
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hack {
+namespace {
+
+class AssemblyCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ = std::filesystem::path(testing::TempDir()) /
+        testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(directory_);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(directory_);
+  }
+
+  std::filesystem::path directory_;
+};
+
+TEST_F(AssemblyCacheTest, MissThenHit) {
+  AssemblyCache cache(directory_);
+  std::string key = AssemblyCache::Key("@1\nD=A\n", "text");
+
+  EXPECT_FALSE(cache.Lookup(key).has_value());
+  ASSERT_TRUE(cache.Store(key, "0000000000000001\n1110110000010000\n"));
+  EXPECT_EQ(cache.Lookup(key), "0000000000000001\n1110110000010000\n");
+
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+TEST_F(AssemblyCacheTest, CountsAreSharedThroughTheDirectory) {
+  std::string key = AssemblyCache::Key("@1\n", "text");
+  AssemblyCache(directory_).Lookup(key);
+  AssemblyCache(directory_).Store(key, "0000000000000001\n");
+  AssemblyCache(directory_).Lookup(key);
+
+  AssemblyCache cache(directory_);
+
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+TEST_F(AssemblyCacheTest, ConcurrentLookupsAreAllCounted) {
+  std::string key = AssemblyCache::Key("@1\n", "text");
+  AssemblyCache(directory_).Store(key, "0000000000000001\n");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&] {
+      AssemblyCache cache(directory_);
+      for (int j = 0; j < 100; j++) {
+        cache.Lookup(key);
+        cache.Lookup("missing");
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  AssemblyCache cache(directory_);
+
+  EXPECT_EQ(cache.hits(), 800);
+  EXPECT_EQ(cache.misses(), 800);
+  // The counts are updated in place rather than appended to.
+  EXPECT_EQ(std::filesystem::file_size(directory_ / "counts"), 16);
+}
+
+TEST_F(AssemblyCacheTest, StoreOverwrites) {
+  AssemblyCache cache(directory_);
+  std::string key = AssemblyCache::Key("@1\n", "text");
+
+  cache.Store(key, "old");
+  cache.Store(key, "new");
+
+  EXPECT_EQ(cache.Lookup(key), "new");
+}
+
+TEST_F(AssemblyCacheTest, BinaryOutputSurvives) {
+  AssemblyCache cache(directory_);
+  std::string key = AssemblyCache::Key("@1\n", "binary");
+  std::string output("HROM\x01\x00\x00\x00\xff", 9);
+
+  cache.Store(key, output);
+
+  EXPECT_EQ(cache.Lookup(key), output);
+}
+
+TEST(AssemblyCacheKeyTest, DependsOnSourceAndVariant) {
+  std::string key = AssemblyCache::Key("@1\n", "text");
+
+  EXPECT_EQ(key.size(), 32);
+  EXPECT_EQ(AssemblyCache::Key("@1\n", "text"), key);
+  EXPECT_NE(AssemblyCache::Key("@2\n", "text"), key);
+  EXPECT_NE(AssemblyCache::Key("@1\n", "binary"), key);
+  EXPECT_NE(AssemblyCache::Key("@1\n\n", "text"), key);
+}
+
+}  // namespace
+}  // namespace hack
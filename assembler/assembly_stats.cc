@@ -0,0 +1,25 @@
+#include "assembler/assembly_stats.h"
+
+#include <ostream>
+
+namespace hack {
+
+void WriteStatsJson(const AssemblyStats& stats, std::ostream& output) {
+  output << "{\"phases_ns\":{"
+         << "\"label_collection\":" << stats.label_collection_ns
+         << ",\"parsing\":" << stats.parsing_ns
+         << ",\"symbol_resolution\":" << stats.symbol_resolution_ns
+         << ",\"encoding\":" << stats.encoding_ns
+         << ",\"optimization\":" << stats.optimization_ns
+         << ",\"output\":" << stats.output_ns
+         << "},\"a_instructions\":" << stats.a_instructions
+         << ",\"c_instructions\":" << stats.c_instructions
+         << ",\"labels\":" << stats.labels
+         << ",\"symbols\":" << stats.symbols
+         << ",\"variables\":" << stats.variables
+         << ",\"bytes_read\":" << stats.bytes_read
+         << ",\"bytes_written\":" << stats.bytes_written
+         << "}\n";
+}
+
+}  // namespace hack
@@ -0,0 +1,73 @@
+#ifndef ASSEMBLER_ASSEMBLY_STATS_H_
+#define ASSEMBLER_ASSEMBLY_STATS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace hack {
+
+// Where the assembler spent its time and how much work it did.
+//
+// Times are wall time in nanoseconds. The clock is read a few times per block
+// of instructions rather than per instruction, so they cost next to nothing to
+// collect. Paths that do two phases in one loop, such as parallel assembly,
+// count the time under the earlier phase.
+struct AssemblyStats {
+  int64_t label_collection_ns = 0;
+
+  int64_t parsing_ns = 0;
+
+  int64_t symbol_resolution_ns = 0;
+
+  int64_t encoding_ns = 0;
+
+  // Time in optimization passes, if any ran.
+  int64_t optimization_ns = 0;
+
+  // Time formatting and writing the output.
+  int64_t output_ns = 0;
+
+  size_t a_instructions = 0;
+
+  size_t c_instructions = 0;
+
+  // Label definitions, i.e. L-instructions.
+  size_t labels = 0;
+
+  // Entries in the final symbol table, including the predefined symbols.
+  size_t symbols = 0;
+
+  size_t variables = 0;
+
+  size_t bytes_read = 0;
+
+  size_t bytes_written = 0;
+};
+
+// Writes `stats` to `output` as a JSON object on one line.
+void WriteStatsJson(const AssemblyStats& stats, std::ostream& output);
+
+// Measures the wall time between laps.
+class Stopwatch final {
+ public:
+  Stopwatch() : lap_start_(Clock::now()) {}
+
+  // Adds the time since the last lap, or since construction, to `total_ns`.
+  void Lap(int64_t& total_ns) {
+    Clock::time_point now = Clock::now();
+    total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        now - lap_start_).count();
+    lap_start_ = now;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point lap_start_;
+};
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_ASSEMBLY_STATS_H_
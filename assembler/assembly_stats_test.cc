@@ -0,0 +1,46 @@
+#include "assembler/assembly_stats.h"
+
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+namespace hack {
+namespace {
+
+TEST(AssemblyStatsTest, WritesJsonOnOneLine) {
+  AssemblyStats stats;
+  stats.parsing_ns = 1500;
+  stats.output_ns = 20;
+  stats.a_instructions = 3;
+  stats.c_instructions = 4;
+  stats.labels = 1;
+  stats.symbols = 25;
+  stats.variables = 2;
+  stats.bytes_read = 40;
+  stats.bytes_written = 119;
+  std::ostringstream output;
+
+  WriteStatsJson(stats, output);
+
+  EXPECT_EQ(output.str(),
+            "{\"phases_ns\":{\"label_collection\":0,\"parsing\":1500,"
+            "\"symbol_resolution\":0,\"encoding\":0,\"optimization\":0,"
+            "\"output\":20},\"a_instructions\":3,\"c_instructions\":4,"
+            "\"labels\":1,\"symbols\":25,\"variables\":2,\"bytes_read\":40,"
+            "\"bytes_written\":119}\n");
+}
+
+TEST(AssemblyStatsTest, StopwatchAccumulatesLaps) {
+  Stopwatch stopwatch;
+  int64_t total_ns = 0;
+
+  stopwatch.Lap(total_ns);
+  int64_t first = total_ns;
+  stopwatch.Lap(total_ns);
+
+  EXPECT_GE(first, 0);
+  EXPECT_GE(total_ns, first);
+}
+
+}  // namespace
+}  // namespace hack
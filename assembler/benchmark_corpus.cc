@@ -0,0 +1,170 @@
+#include "assembler/benchmark_corpus.h"
+
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "translator/code_writer.h"
+
+namespace hack {
+
+namespace {
+
+constexpr std::string_view kArithmeticCommands[] = {
+  "add", "sub", "neg", "eq", "gt", "lt", "and", "or", "not",
+};
+
+constexpr std::string_view kSegments[] = {
+  "local", "argument", "this", "that", "temp", "pointer", "static",
+};
+
+constexpr int kLabelsPerFunction = 8;
+
+constexpr int kCommandsPerFunction = 200;
+
+// Counts instructions, i.e. lines other than labels, comments and blanks.
+int CountInstructions(std::string_view assembly) {
+  int count = 0;
+  size_t begin = 0;
+  while (begin < assembly.size()) {
+    size_t end = assembly.find('\n', begin);
+    if (end == std::string_view::npos) {
+      end = assembly.size();
+    }
+    std::string_view line = assembly.substr(begin, end - begin);
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first != std::string_view::npos && line[first] != '(' &&
+        line.substr(first, 2) != "//") {
+      count++;
+    }
+    begin = end + 1;
+  }
+  return count;
+}
+
+// A stream buffer whose contents can be read without copying them, unlike
+// std::stringbuf's before C++20.
+class StringBuffer final : public std::streambuf {
+ public:
+  std::string& text() { return text_; }
+
+ protected:
+  int_type overflow(int_type ch) override {
+    if (ch != traits_type::eof()) {
+      text_.push_back(static_cast<char>(ch));
+    }
+    return ch;
+  }
+
+  std::streamsize xsputn(const char* data, std::streamsize size) override {
+    text_.append(data, size);
+    return size;
+  }
+
+ private:
+  std::string text_;
+};
+
+class ProgramGenerator {
+ public:
+  explicit ProgramGenerator(uint32_t seed)
+      : random_(seed), output_(&buffer_), code_writer_(output_) {}
+
+  std::string Generate(int num_instructions) {
+    code_writer_.SetFileName("Main.vm");
+    code_writer_.WriteBootstrap();
+    // Sys.init comes first so that every later function has something to
+    // call.
+    WriteFunction("Sys.init");
+    int count = 0;
+    size_t counted = 0;
+    for (;;) {
+      std::string_view text = buffer_.text();
+      count += CountInstructions(text.substr(counted));
+      counted = text.size();
+      if (count >= num_instructions) {
+        break;
+      }
+      WriteFunction("Main.f" + std::to_string(functions_.size()));
+    }
+    code_writer_.Close();
+    output_.flush();
+    return std::move(buffer_.text());
+  }
+
+ private:
+  int Uniform(int min, int max) {
+    return std::uniform_int_distribution<int>(min, max)(random_);
+  }
+
+  void WriteFunction(const std::string& name) {
+    code_writer_.WriteFunction(name, Uniform(0, 3));
+    std::vector<bool> defined(kLabelsPerFunction);
+    for (int i = 0; i < kCommandsPerFunction; i++) {
+      int choice = Uniform(0, 99);
+      if (choice < 30) {
+        code_writer_.WritePush("constant", Uniform(0, 32767));
+      } else if (choice < 45) {
+        WriteSegmentAccess(/*push=*/true);
+      } else if (choice < 55) {
+        WriteSegmentAccess(/*push=*/false);
+      } else if (choice < 80) {
+        code_writer_.WriteArithmetic(
+            kArithmeticCommands[Uniform(0, std::size(kArithmeticCommands) - 1)]);
+      } else if (choice < 85) {
+        int label = Uniform(0, kLabelsPerFunction - 1);
+        if (!defined[label]) {
+          defined[label] = true;
+          code_writer_.WriteLabel("L" + std::to_string(label));
+        }
+      } else if (choice < 90) {
+        code_writer_.WriteGoto(
+            "L" + std::to_string(Uniform(0, kLabelsPerFunction - 1)));
+      } else if (choice < 95) {
+        code_writer_.WriteIf(
+            "L" + std::to_string(Uniform(0, kLabelsPerFunction - 1)));
+      } else if (!functions_.empty()) {
+        code_writer_.WriteCall(functions_[Uniform(0, functions_.size() - 1)],
+                               Uniform(0, 3));
+      }
+    }
+    for (int label = 0; label < kLabelsPerFunction; label++) {
+      if (!defined[label]) {
+        code_writer_.WriteLabel("L" + std::to_string(label));
+      }
+    }
+    code_writer_.WriteReturn();
+    functions_.push_back(name);
+  }
+
+  void WriteSegmentAccess(bool push) {
+    std::string_view segment = kSegments[Uniform(0, std::size(kSegments) - 1)];
+    int offset = Uniform(0, segment == "pointer" ? 1 : 7);
+    if (push) {
+      code_writer_.WritePush(segment, offset);
+    } else {
+      code_writer_.WritePop(segment, offset);
+    }
+  }
+
+  std::mt19937 random_;
+
+  StringBuffer buffer_;
+
+  std::ostream output_;
+
+  translator::CodeWriter code_writer_;
+
+  std::vector<std::string> functions_;
+};
+
+}  // namespace
+
+std::string GenerateTranslatedProgram(int num_instructions, uint32_t seed) {
+  return ProgramGenerator(seed).Generate(num_instructions);
+}
+
+}  // namespace hack
@@ -0,0 +1,18 @@
+#ifndef ASSEMBLER_BENCHMARK_CORPUS_H_
+#define ASSEMBLER_BENCHMARK_CORPUS_H_
+
+#include <cstdint>
+#include <string>
+
+namespace hack {
+
+// Returns assembly for a random VM program of at least `num_instructions`
+// instructions, as written by the translator: bootstrap code, then functions
+// that push, pop, compute, branch to their own labels and call earlier
+// functions. The same seed always gives the same program.
+std::string GenerateTranslatedProgram(int num_instructions,
+                                      uint32_t seed = 1);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_BENCHMARK_CORPUS_H_
@@ -0,0 +1,43 @@
+#include "assembler/benchmark_corpus.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "assembler/assemble.h"
+
+namespace hack {
+namespace {
+
+TEST(BenchmarkCorpusTest, GeneratesAtLeastTheRequestedSize) {
+  std::string program = GenerateTranslatedProgram(10000);
+
+  AssemblyResult result = Assemble(program);
+
+  EXPECT_GE(result.words.size(), 10000);
+  EXPECT_LT(result.words.size(), 20000);
+}
+
+TEST(BenchmarkCorpusTest, IsDeterministic) {
+  EXPECT_EQ(GenerateTranslatedProgram(1000, 7),
+            GenerateTranslatedProgram(1000, 7));
+  EXPECT_NE(GenerateTranslatedProgram(1000, 7),
+            GenerateTranslatedProgram(1000, 8));
+}
+
+TEST(BenchmarkCorpusTest, AssemblesTheSameInEveryMode) {
+  std::string program = GenerateTranslatedProgram(20000);
+
+  AssemblyOptions single_pass;
+  single_pass.single_pass = true;
+  AssemblyOptions parallel;
+  parallel.num_threads = 4;
+
+  std::vector<uint16_t> words = Assemble(program).words;
+
+  EXPECT_EQ(Assemble(program, single_pass).words, words);
+  EXPECT_EQ(Assemble(program, parallel).words, words);
+}
+
+}  // namespace
+}  // namespace hack
@@ -1,100 +1,67 @@
 #include "assembler/code.h"
 
-#include <array>
+#include <string>
 #include <string_view>
 
+#include "assembler/code_tables.h"
+
 namespace hack {
 
-constexpr std::string_view kJumpTable[] = {
-  "", "000",
-  "JGT", "001",
-  "JEQ", "010",
-  "JGE", "011",
-  "JLT", "100",
-  "JNE", "101",
-  "JLE", "110",
-  "JMP", "111"
-};
-
-constexpr std::string_view kDestTable[] = {
-  "", "000",
-  "M", "001",
-  "D", "010",
-  "DM", "011",
-  "MD", "011",
-  "A", "100",
-  "AM", "101",
-  "MA", "101",
-  "AD", "110",
-  "DA", "110",
-  "ADM", "111",
-  "AMD", "111",
-  "MDA", "111",
-  "MAD", "111",
-  "DAM", "111",
-  "DMA", "111"
-};
-
-constexpr std::string_view kCompTable[] = {
-  "0", "0101010",
-  "1", "0111111",
-  "-1", "0111010",
-  "D", "0001100",
-  "A", "0110000",
-  "M", "1110000",
-  "!D", "0001101",
-  "!A", "0110001",
-  "!M", "1110001",
-  "-D", "0001111",
-  "-A", "0110011",
-  "-M", "1110011",
-  "D+1", "0011111",
-  "A+1", "0110111",
-  "M+1", "1110111",
-  "D-1", "0001110",
-  "A-1", "0110010",
-  "M-1", "1110010",
-  "D+A", "0000010",
-  "D+M", "1000010",
-  "D-A", "0010011",
-  "D-M", "1010011",
-  "A-D", "0000111",
-  "M-D", "1000111",
-  "D&A", "0000000",
-  "D&M", "1000000",
-  "D|A", "0010101",
-  "D|M", "1010101"
-};
+namespace {
 
-std::string DestToBinary(std::string_view dest) {
-  size_t len = std::size(kDestTable);
-  for (size_t i = 0; i < len; i += 2) {
-    if (dest == kDestTable[i]) {
-      return std::string(kDestTable[i + 1]);
+static_assert(kJumpHash.Find("JMP") == 0b111);
+static_assert(kDestHash.Find("AMD") == 0b111);
+static_assert(kCompHash.Find("D|M") == 0b1010101);
+static_assert(kCompHash.Find("X") == -1);
+static_assert(kCompHash.Find("M + 1") == -1);
+
+constexpr uint16_t kDefaultComp = 0b0101010;
+
+// Formats the low `width` bits of `value` as a string of '0' and '1'.
+std::string BitsToString(uint16_t value, int width) {
+  std::string bits(width, '0');
+  for (int i = 0; i < width; i++) {
+    if ((value >> (width - 1 - i)) & 1) {
+      bits[i] = '1';
     }
   }
-  return "000";
+  return bits;
 }
 
-std::string CompToBinary(std::string_view comp) {
-  size_t len = std::size(kCompTable);
-  for (size_t i = 0; i < len; i += 2) {
-    if (comp == kCompTable[i]) {
-      return std::string(kCompTable[i + 1]);
-    }
-  }
+}  // namespace
+
+uint16_t EncodeDest(std::string_view dest) {
+  int bits = kDestHash.Find(dest);
+  return bits < 0 ? 0 : bits;
+}
+
+uint16_t EncodeComp(std::string_view comp) {
+  int bits = kCompHash.Find(comp);
   // Return error instead?
-  return "0101010";
+  return bits < 0 ? kDefaultComp : bits;
+}
+
+uint16_t EncodeJump(std::string_view jump) {
+  int bits = kJumpHash.Find(jump);
+  return bits < 0 ? 0 : bits;
+}
+
+uint16_t EncodeCInstruction(std::string_view dest, std::string_view comp,
+                            std::string_view jump) {
+  return 0xe000 | EncodeComp(comp) << 6 | EncodeDest(dest) << 3 |
+      EncodeJump(jump);
+}
+
+std::string DestToBinary(std::string_view dest) {
+  return BitsToString(EncodeDest(dest), 3);
+}
+
+std::string CompToBinary(std::string_view comp) {
+  return BitsToString(EncodeComp(comp), 7);
 }
 
 std::string JumpToBinary(std::string_view jump) {
-  size_t len = std::size(kJumpTable);
-  for (size_t i = 0; i < len; i += 2) {
-    if (jump == kJumpTable[i]) {
-      return std::string(kJumpTable[i + 1]);
-    }
-  }
-  return "000";
+  return BitsToString(EncodeJump(jump), 3);
 }
 
 }  // namespace hack
@@ -1,11 +1,28 @@
 #ifndef ASSEMBLER_CODE_H_
 #define ASSEMBLER_CODE_H_
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 
 namespace hack {
 
+// Returns the 3 dest bits for a dest mnemonic. Unrecognised mnemonics encode
+// as no destination.
+uint16_t EncodeDest(std::string_view dest);
+
+// Returns the 7 comp bits (a, c1-c6) for a comp mnemonic. Unrecognised
+// mnemonics encode as "0".
+uint16_t EncodeComp(std::string_view comp);
+
+// Returns the 3 jump bits for a jump mnemonic. Unrecognised mnemonics encode as
+// no jump.
+uint16_t EncodeJump(std::string_view jump);
+
+// Returns the complete 16-bit C-instruction for the given mnemonics.
+uint16_t EncodeCInstruction(std::string_view dest, std::string_view comp,
+                            std::string_view jump);
+
 // Converts dest mnemonic into binary string.
 std::string DestToBinary(std::string_view dest);
 
@@ -0,0 +1,171 @@
+#ifndef ASSEMBLER_CODE_TABLES_H_
+#define ASSEMBLER_CODE_TABLES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// The C-instruction mnemonic tables and the compile-time perfect hash tables
+// built from them. Shared by the encoder in code.cc and the compile-time
+// assembler in constexpr_assembler.h.
+
+namespace hack {
+
+inline constexpr std::string_view kJumpTable[] = {
+  "", "000",
+  "JGT", "001",
+  "JEQ", "010",
+  "JGE", "011",
+  "JLT", "100",
+  "JNE", "101",
+  "JLE", "110",
+  "JMP", "111"
+};
+
+inline constexpr std::string_view kDestTable[] = {
+  "", "000",
+  "M", "001",
+  "D", "010",
+  "DM", "011",
+  "MD", "011",
+  "A", "100",
+  "AM", "101",
+  "MA", "101",
+  "AD", "110",
+  "DA", "110",
+  "ADM", "111",
+  "AMD", "111",
+  "MDA", "111",
+  "MAD", "111",
+  "DAM", "111",
+  "DMA", "111"
+};
+
+inline constexpr std::string_view kCompTable[] = {
+  "0", "0101010",
+  "1", "0111111",
+  "-1", "0111010",
+  "D", "0001100",
+  "A", "0110000",
+  "M", "1110000",
+  "!D", "0001101",
+  "!A", "0110001",
+  "!M", "1110001",
+  "-D", "0001111",
+  "-A", "0110011",
+  "-M", "1110011",
+  "D+1", "0011111",
+  "A+1", "0110111",
+  "M+1", "1110111",
+  "D-1", "0001110",
+  "A-1", "0110010",
+  "M-1", "1110010",
+  "D+A", "0000010",
+  "D+M", "1000010",
+  "D-A", "0010011",
+  "D-M", "1010011",
+  "A-D", "0000111",
+  "M-D", "1000111",
+  "D&A", "0000000",
+  "D&M", "1000000",
+  "D|A", "0010101",
+  "D|M", "1010101"
+};
+
+namespace code_internal {
+
+// Marks an empty slot in a PerfectHashTable. No mnemonic packs to this.
+inline constexpr uint32_t kNoKey = 0xffffffff;
+
+// Packs a mnemonic of up to three characters, with its length, into a single
+// integer so that it can be hashed and compared in one operation. Anything
+// longer is not a mnemonic and packs to kNoKey.
+constexpr uint32_t PackMnemonic(std::string_view mnemonic) {
+  if (mnemonic.size() > 3) {
+    return kNoKey;
+  }
+  uint32_t key = mnemonic.size();
+  for (size_t i = 0; i < mnemonic.size(); i++) {
+    key |= static_cast<uint32_t>(static_cast<unsigned char>(mnemonic[i]))
+        << (8 * (i + 1));
+  }
+  return key;
+}
+
+// Parses a string of '0' and '1' characters.
+constexpr uint16_t ParseBits(std::string_view bits) {
+  uint16_t value = 0;
+  for (char ch : bits) {
+    value = (value << 1) | (ch == '1');
+  }
+  return value;
+}
+
+// Maps the mnemonics of one of the tables above to their encoded bits. The
+// table is built at compile time: a multiplicative hash seed is searched for
+// until every mnemonic lands in its own slot, so a lookup is one multiply, one
+// shift and one compare.
+template <int kBits>
+struct PerfectHashTable {
+  static constexpr int kSlots = 1 << kBits;
+
+  uint32_t seed = 0;
+
+  uint32_t keys[kSlots] = {};
+
+  uint16_t values[kSlots] = {};
+
+  constexpr int Slot(uint32_t key) const {
+    return static_cast<uint32_t>(key * seed) >> (32 - kBits);
+  }
+
+  // Returns the bits for `mnemonic`, or -1 if it is not in the table.
+  constexpr int Find(std::string_view mnemonic) const {
+    uint32_t key = PackMnemonic(mnemonic);
+    if (key == kNoKey) {
+      return -1;
+    }
+    int slot = Slot(key);
+    return keys[slot] == key ? values[slot] : -1;
+  }
+};
+
+template <int kBits, size_t N>
+constexpr PerfectHashTable<kBits> BuildPerfectHashTable(
+    const std::string_view (&table)[N]) {
+  PerfectHashTable<kBits> hash_table;
+  // Seeds are odd multipliers stepped by a golden-ratio increment.
+  for (uint32_t seed = 0x9e3779b1;; seed = (seed + 0x7f4a7c16) | 1) {
+    hash_table.seed = seed;
+    for (uint32_t& key : hash_table.keys) {
+      key = kNoKey;
+    }
+    bool collided = false;
+    for (size_t i = 0; i < N; i += 2) {
+      uint32_t key = PackMnemonic(table[i]);
+      int slot = hash_table.Slot(key);
+      if (hash_table.keys[slot] != kNoKey) {
+        collided = true;
+        break;
+      }
+      hash_table.keys[slot] = key;
+      hash_table.values[slot] = ParseBits(table[i + 1]);
+    }
+    if (!collided) {
+      return hash_table;
+    }
+  }
+}
+
+}  // namespace code_internal
+
+inline constexpr auto kJumpHash =
+    code_internal::BuildPerfectHashTable<5>(kJumpTable);
+inline constexpr auto kDestHash =
+    code_internal::BuildPerfectHashTable<5>(kDestTable);
+inline constexpr auto kCompHash =
+    code_internal::BuildPerfectHashTable<6>(kCompTable);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_CODE_TABLES_H_
@@ -25,6 +25,34 @@ TEST(CodeTest, CompToBinaryM) {
   EXPECT_EQ(CompToBinary("M"), "1110000");
 }
 
+TEST(CodeTest, CompToBinaryUnknownIsZero) {
+  EXPECT_EQ(CompToBinary("M + 1"), "0101010");
+}
+
+TEST(CodeTest, EncodeEveryDestPermutation) {
+  EXPECT_EQ(EncodeDest("AMD"), 0b111);
+  EXPECT_EQ(EncodeDest("DMA"), 0b111);
+  EXPECT_EQ(EncodeDest("MA"), 0b101);
+  EXPECT_EQ(EncodeDest("MM"), 0);
+}
+
+TEST(CodeTest, EncodeComp) {
+  EXPECT_EQ(EncodeComp("D-M"), 0b1010011);
+  EXPECT_EQ(EncodeComp("-1"), 0b0111010);
+  EXPECT_EQ(EncodeComp("D+Q"), 0b0101010);
+}
+
+TEST(CodeTest, EncodeJump) {
+  EXPECT_EQ(EncodeJump(""), 0);
+  EXPECT_EQ(EncodeJump("JLE"), 0b110);
+  EXPECT_EQ(EncodeJump("JMPX"), 0);
+}
+
+TEST(CodeTest, EncodeCInstruction) {
+  EXPECT_EQ(EncodeCInstruction("D", "M+1", "JNE"), 0b1111110111010101);
+  EXPECT_EQ(EncodeCInstruction("", "0", "JMP"), 0b1110101010000111);
+}
+
 }  // namespace
 }  // namespace hack
 
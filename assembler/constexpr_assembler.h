@@ -0,0 +1,269 @@
+#ifndef ASSEMBLER_CONSTEXPR_ASSEMBLER_H_
+#define ASSEMBLER_CONSTEXPR_ASSEMBLER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+#include "assembler/code_tables.h"
+#include "assembler/symbol_table.h"
+
+// Assembles Hack assembly at compile time, for small routines embedded in C++
+// source. The argument is a string literal or a constexpr std::string_view
+// defined outside the current function:
+//
+//   constexpr std::array<uint16_t, 2> kHalt = HACK_ASSEMBLE(R"asm(
+//     (HALT)
+//     @HALT
+//     0;JMP
+//   )asm");
+//
+// The words are the same as Assemble() gives at run time, including labels,
+// predefined symbols and variables. A malformed instruction fails the build
+// with an error naming one of the functions in hack::constexpr_errors, e.g.
+// "call to non-'constexpr' function 'void
+// hack::constexpr_errors::UnknownCompMnemonic()'".
+#define HACK_ASSEMBLE(source)                                   \
+  ([] {                                                         \
+    constexpr auto kWords = ::hack::AssembleConstexpr<          \
+        ::hack::CountConstexprInstructions(source),             \
+        ::hack::CountConstexprLabels(source)>(source);          \
+    return kWords;                                              \
+  }())
+
+namespace hack {
+
+// None of these are constexpr, so reaching one while assembling at compile time
+// is an error that names it. Reaching one at run time aborts.
+namespace constexpr_errors {
+
+inline void UnknownDestMnemonic() { std::abort(); }
+inline void UnknownCompMnemonic() { std::abort(); }
+inline void UnknownJumpMnemonic() { std::abort(); }
+inline void ConstantOutOfRange() { std::abort(); }
+inline void MalformedSymbol() { std::abort(); }
+inline void MalformedLabel() { std::abort(); }
+
+}  // namespace constexpr_errors
+
+namespace constexpr_internal {
+
+constexpr bool IsSpace(char ch) {
+  return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\v' ||
+      ch == '\f';
+}
+
+constexpr bool IsDigit(char ch) {
+  return ch >= '0' && ch <= '9';
+}
+
+// As Parser::IsSymbolChar.
+constexpr bool IsSymbolChar(char ch) {
+  return IsDigit(ch) || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+      ch == '_' || ch == '.' || ch == '$' || ch == ':';
+}
+
+constexpr std::string_view Trim(std::string_view text) {
+  while (!text.empty() && IsSpace(text.front())) {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && IsSpace(text.back())) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+// Calls `fn(line)` for every line of `source` that holds an instruction, with
+// any comment and surrounding whitespace removed.
+template <typename Fn>
+constexpr void ForEachInstruction(std::string_view source, Fn&& fn) {
+  while (!source.empty()) {
+    size_t newline = source.find('\n');
+    std::string_view line = source.substr(0, newline);
+    source.remove_prefix(newline == std::string_view::npos ? source.size()
+                                                           : newline + 1);
+    line = Trim(line.substr(0, line.find("//")));
+    if (!line.empty()) {
+      fn(line);
+    }
+  }
+}
+
+// Returns the symbol of a label definition such as (LOOP).
+constexpr std::string_view LabelSymbol(std::string_view line) {
+  if (line.size() < 3 || line.back() != ')') {
+    constexpr_errors::MalformedLabel();
+  }
+  std::string_view symbol = line.substr(1, line.size() - 2);
+  for (char ch : symbol) {
+    if (!IsSymbolChar(ch)) {
+      constexpr_errors::MalformedLabel();
+    }
+  }
+  return symbol;
+}
+
+// A fixed-capacity symbol table searched linearly, which is fast enough for
+// the small routines this is meant for.
+template <size_t kCapacity>
+struct SymbolList {
+  std::array<std::string_view, kCapacity> symbols{};
+
+  std::array<int, kCapacity> values{};
+
+  size_t size = 0;
+
+  constexpr int Find(std::string_view symbol) const {
+    for (size_t i = 0; i < size; i++) {
+      if (symbols[i] == symbol) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  // Later definitions win, as in SymbolTable::AddEntry.
+  constexpr void Set(std::string_view symbol, int value) {
+    int index = Find(symbol);
+    if (index < 0) {
+      index = static_cast<int>(size++);
+      symbols[index] = symbol;
+    }
+    values[index] = value;
+  }
+};
+
+// Returns the value of the A-instruction @`symbol`, allocating a variable if
+// it is new.
+template <size_t kCapacity>
+constexpr int ResolveSymbol(std::string_view symbol,
+                            SymbolList<kCapacity>& symbols,
+                            int& next_variable_address) {
+  if (symbol.empty()) {
+    constexpr_errors::MalformedSymbol();
+  }
+  if (IsDigit(symbol[0])) {
+    int value = 0;
+    for (char ch : symbol) {
+      if (!IsDigit(ch)) {
+        constexpr_errors::MalformedSymbol();
+      }
+      value = value * 10 + (ch - '0');
+      if (value > 0x7fff) {
+        constexpr_errors::ConstantOutOfRange();
+      }
+    }
+    return value;
+  }
+  for (char ch : symbol) {
+    if (!IsSymbolChar(ch)) {
+      constexpr_errors::MalformedSymbol();
+    }
+  }
+  int index = symbols.Find(symbol);
+  if (index >= 0) {
+    return symbols.values[index];
+  }
+  symbols.Set(symbol, next_variable_address);
+  return next_variable_address++;
+}
+
+// Encodes a C-instruction such as AM=M+1 or D;JGT.
+constexpr uint16_t EncodeC(std::string_view line) {
+  std::string_view dest;
+  std::string_view jump;
+  size_t semicolon = line.find(';');
+  if (semicolon != std::string_view::npos) {
+    jump = Trim(line.substr(semicolon + 1));
+    line = line.substr(0, semicolon);
+  }
+  size_t equals = line.find('=');
+  if (equals != std::string_view::npos) {
+    dest = Trim(line.substr(0, equals));
+    line = line.substr(equals + 1);
+  }
+  std::string_view comp = Trim(line);
+
+  int dest_bits = kDestHash.Find(dest);
+  if (dest_bits < 0) {
+    constexpr_errors::UnknownDestMnemonic();
+  }
+  int comp_bits = kCompHash.Find(comp);
+  if (comp_bits < 0) {
+    constexpr_errors::UnknownCompMnemonic();
+  }
+  int jump_bits = kJumpHash.Find(jump);
+  if (jump_bits < 0) {
+    constexpr_errors::UnknownJumpMnemonic();
+  }
+  return 0xe000 | comp_bits << 6 | dest_bits << 3 | jump_bits;
+}
+
+}  // namespace constexpr_internal
+
+// The number of words `source` assembles to.
+constexpr size_t CountConstexprInstructions(std::string_view source) {
+  size_t count = 0;
+  constexpr_internal::ForEachInstruction(source, [&](std::string_view line) {
+    if (line[0] != '(') {
+      count++;
+    }
+  });
+  return count;
+}
+
+// The number of label definitions in `source`.
+constexpr size_t CountConstexprLabels(std::string_view source) {
+  size_t count = 0;
+  constexpr_internal::ForEachInstruction(source, [&](std::string_view line) {
+    if (line[0] == '(') {
+      count++;
+    }
+  });
+  return count;
+}
+
+// Assembles `source`, which has `kWords` instructions and `kLabels` label
+// definitions. Use HACK_ASSEMBLE rather than calling this directly.
+template <size_t kWords, size_t kLabels>
+constexpr std::array<uint16_t, kWords> AssembleConstexpr(
+    std::string_view source) {
+  // Every word could introduce a variable.
+  constexpr size_t kCapacity = std::size(kPredefinedSymbols) + kLabels + kWords;
+  constexpr_internal::SymbolList<kCapacity> symbols;
+  for (const auto& [symbol, value] : kPredefinedSymbols) {
+    symbols.Set(symbol, value);
+  }
+
+  int address = 0;
+  constexpr_internal::ForEachInstruction(source, [&](std::string_view line) {
+    if (line[0] == '(') {
+      symbols.Set(constexpr_internal::LabelSymbol(line), address);
+    } else {
+      address++;
+    }
+  });
+
+  std::array<uint16_t, kWords> words{};
+  size_t i = 0;
+  int next_variable_address = kFirstVariableAddress;
+  constexpr_internal::ForEachInstruction(source, [&](std::string_view line) {
+    if (line[0] == '(') {
+      return;
+    }
+    if (line[0] == '@') {
+      words[i++] = constexpr_internal::ResolveSymbol(
+          constexpr_internal::Trim(line.substr(1)), symbols,
+          next_variable_address);
+    } else {
+      words[i++] = constexpr_internal::EncodeC(line);
+    }
+  });
+  return words;
+}
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_CONSTEXPR_ASSEMBLER_H_
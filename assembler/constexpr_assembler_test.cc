@@ -0,0 +1,81 @@
+#include "assembler/constexpr_assembler.h"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/assemble.h"
+
+namespace hack {
+namespace {
+
+constexpr std::string_view kProgram = R"asm(
+// Forward and backward label references, variables and predefined symbols.
+@i
+M=1
+(LOOP)
+@i
+D=M
+@100
+D=D-A   // Trailing comment.
+@END
+D;JGT
+@sum
+M=D+M
+@i
+M=M+1
+@LOOP
+0;JMP
+(END)
+@END
+0;JMP
+@KBD
+@j
+)asm";
+
+constexpr std::string_view kMnemonics = R"asm(
+  AMD=D|M;JLE
+  MD = !A ; JNE
+  M-D;JLT
+  A=-1
+  0;JMP
+)asm";
+
+constexpr auto kTwoWords = HACK_ASSEMBLE("@2\nD=A\n");
+static_assert(kTwoWords.size() == 2);
+static_assert(kTwoWords[0] == 2);
+static_assert(kTwoWords[1] == 0xec10);
+static_assert(HACK_ASSEMBLE("// Nothing here.\n").empty());
+
+template <size_t N>
+std::vector<uint16_t> ToVector(const std::array<uint16_t, N>& words) {
+  return std::vector<uint16_t>(words.begin(), words.end());
+}
+
+TEST(ConstexprAssemblerTest, MatchesRuntimeAssembler) {
+  constexpr auto kWords = HACK_ASSEMBLE(kProgram);
+
+  EXPECT_EQ(ToVector(kWords), Assemble(kProgram).words);
+}
+
+TEST(ConstexprAssemblerTest, AcceptsSpacesAroundMnemonics) {
+  constexpr auto kWords = HACK_ASSEMBLE(kMnemonics);
+
+  EXPECT_EQ(ToVector(kWords), Assemble(kMnemonics).words);
+}
+
+TEST(ConstexprAssemblerTest, LaterLabelDefinitionsWin) {
+  constexpr auto kWords = HACK_ASSEMBLE("(A)\n@A\n(A)\n@A\n");
+
+  EXPECT_EQ(ToVector(kWords), (std::vector<uint16_t>{1, 1}));
+}
+
+// Malformed instructions fail to compile, e.g. HACK_ASSEMBLE("D=D*A") with
+// "call to non-'constexpr' function '...UnknownCompMnemonic()'". There is no
+// way to test that from here.
+
+}  // namespace
+}  // namespace hack
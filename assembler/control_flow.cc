@@ -0,0 +1,237 @@
+#include "assembler/control_flow.h"
+
+#include <string_view>
+#include <unordered_map>
+
+namespace hack {
+
+namespace {
+
+bool IsLabel(const Instruction& instruction) {
+  return instruction.instruction_type == InstructionType::kLInstruction;
+}
+
+bool IsJump(const Instruction& instruction) {
+  return instruction.instruction_type == InstructionType::kCInstruction &&
+      !instruction.jump.empty();
+}
+
+// A jump with no other effect: it stores nothing and does not read memory.
+bool IsPureJump(const Instruction& instruction) {
+  return IsJump(instruction) && instruction.destination.empty() &&
+      instruction.comparison.find_first_of("AM") == std::string_view::npos;
+}
+
+// A run of instructions [begin, end) that is only entered at the top. Any
+// labels come first.
+struct Block {
+  int begin;
+  int end;
+};
+
+class ControlFlowGraph {
+ public:
+  explicit ControlFlowGraph(std::vector<Instruction>& program)
+      : program_(program) {
+    int n = program.size();
+    for (int i = 0; i < n; i++) {
+      bool starts_block = i == 0 ||
+          (IsLabel(program[i]) && !IsLabel(program[i - 1])) ||
+          IsJump(program[i - 1]);
+      if (starts_block) {
+        if (!blocks_.empty()) {
+          blocks_.back().end = i;
+        }
+        blocks_.push_back({i, n});
+      }
+      if (IsLabel(program[i])) {
+        block_of_label_[program[i].symbol] = blocks_.size() - 1;
+      }
+    }
+  }
+
+  // Returns false if indirect jumps could target something other than labels
+  // whose address is taken.
+  bool Analyze() {
+    bool has_indirect_jump = false;
+    bool takes_address = false;
+    for (int i = 0; i < static_cast<int>(program_.size()); i++) {
+      const Instruction& instruction = program_[i];
+      if (IsJump(instruction) && DirectTarget(i) < 0) {
+        // E.g. @100, 0;JMP or @R15, 0;JMP.
+        if (i > 0 && program_[i - 1].instruction_type ==
+                         InstructionType::kAInstruction &&
+            block_of_label_.count(program_[i - 1].symbol) == 0) {
+          return false;
+        }
+        has_indirect_jump = true;
+      }
+      if (instruction.instruction_type == InstructionType::kAInstruction &&
+          block_of_label_.count(instruction.symbol) > 0 &&
+          !IsDirectJumpLoad(i)) {
+        address_taken_.push_back(block_of_label_[instruction.symbol]);
+        takes_address = true;
+      }
+    }
+    return !has_indirect_jump || takes_address;
+  }
+
+  // Points direct jumps that land on "@L, 0;JMP" blocks at L instead.
+  int ThreadJumps() {
+    int threaded = 0;
+    for (int i = 0; i < static_cast<int>(program_.size()); i++) {
+      int target = DirectTarget(i);
+      if (target < 0 || !ADeadAfter(i)) {
+        continue;
+      }
+      // Bounded in case trampolines form a cycle.
+      int final_target = target;
+      for (size_t hops = 0; hops < blocks_.size(); hops++) {
+        int next = TrampolineTarget(final_target);
+        if (next < 0 || next == final_target || next == target) {
+          break;
+        }
+        final_target = next;
+      }
+      if (final_target == target) {
+        continue;
+      }
+      // Every jump target starts with a label.
+      program_[i - 1].symbol = program_[blocks_[final_target].begin].symbol;
+      threaded++;
+    }
+    return threaded;
+  }
+
+  // Removes blocks that cannot be reached from address 0.
+  void RemoveUnreachable(ControlFlowStats& stats) {
+    std::vector<bool> reachable(blocks_.size());
+    std::vector<int> work = address_taken_;
+    work.push_back(0);
+    while (!work.empty()) {
+      int b = work.back();
+      work.pop_back();
+      if (reachable[b]) {
+        continue;
+      }
+      reachable[b] = true;
+      const Block& block = blocks_[b];
+      int last = block.end - 1;
+      int target = DirectTarget(last);
+      if (target >= 0) {
+        work.push_back(target);
+      }
+      bool falls_through =
+          !IsJump(program_[last]) || program_[last].jump != "JMP";
+      if (falls_through && b + 1 < static_cast<int>(blocks_.size())) {
+        work.push_back(b + 1);
+      }
+    }
+
+    std::vector<Instruction> output;
+    output.reserve(program_.size());
+    for (size_t b = 0; b < blocks_.size(); b++) {
+      const Block& block = blocks_[b];
+      if (reachable[b]) {
+        output.insert(output.end(), program_.begin() + block.begin,
+                      program_.begin() + block.end);
+        continue;
+      }
+      stats.blocks_removed++;
+      for (int i = block.begin; i < block.end; i++) {
+        if (!IsLabel(program_[i])) {
+          stats.instructions_removed++;
+        }
+      }
+    }
+    program_.swap(output);
+  }
+
+ private:
+  // Returns true if instruction i is an A-instruction whose only use is as the
+  // target of the jump right after it.
+  bool IsDirectJumpLoad(int i) const {
+    return i + 1 < static_cast<int>(program_.size()) &&
+        IsPureJump(program_[i + 1]);
+  }
+
+  // Returns the block that instruction i jumps to if it is a direct jump to a
+  // label, or -1.
+  int DirectTarget(int i) const {
+    if (i <= 0 || !IsJump(program_[i]) || !IsDirectJumpLoad(i - 1) ||
+        program_[i - 1].instruction_type != InstructionType::kAInstruction) {
+      return -1;
+    }
+    auto it = block_of_label_.find(program_[i - 1].symbol);
+    return it == block_of_label_.end() ? -1 : it->second;
+  }
+
+  // Returns the block that block b jumps to if all it does is jump there
+  // unconditionally, or -1.
+  int TrampolineTarget(int b) const {
+    const Block& block = blocks_[b];
+    int first = block.begin;
+    while (first < block.end && IsLabel(program_[first])) {
+      first++;
+    }
+    if (block.end - first != 2 || program_[block.end - 1].jump != "JMP") {
+      return -1;
+    }
+    return DirectTarget(block.end - 1);
+  }
+
+  // Returns true if the value of A after the jump at i is never read when the
+  // jump is not taken, so the label it loads may change.
+  bool ADeadAfter(int i) const {
+    if (program_[i].jump == "JMP") {
+      return true;
+    }
+    for (size_t j = i + 1; j < program_.size(); j++) {
+      const Instruction& instruction = program_[j];
+      switch (instruction.instruction_type) {
+        case InstructionType::kLInstruction:
+          continue;
+        case InstructionType::kAInstruction:
+          return true;
+        case InstructionType::kCInstruction:
+          break;
+      }
+      if (instruction.comparison.find_first_of("AM") != std::string_view::npos ||
+          instruction.destination.find('M') != std::string_view::npos ||
+          !instruction.jump.empty()) {
+        return false;
+      }
+      if (instruction.destination.find('A') != std::string_view::npos) {
+        return true;
+      }
+    }
+    return true;
+  }
+
+  std::vector<Instruction>& program_;
+
+  std::vector<Block> blocks_;
+
+  std::unordered_map<std::string_view, int> block_of_label_;
+
+  // Blocks whose label is loaded other than to jump to it.
+  std::vector<int> address_taken_;
+};
+
+}  // namespace
+
+ControlFlowStats SimplifyControlFlow(std::vector<Instruction>& program) {
+  ControlFlowStats stats;
+  if (program.empty()) {
+    return stats;
+  }
+  ControlFlowGraph graph(program);
+  if (!graph.Analyze()) {
+    return stats;
+  }
+  stats.jumps_threaded = graph.ThreadJumps();
+  graph.RemoveUnreachable(stats);
+  return stats;
+}
+
+}  // namespace hack
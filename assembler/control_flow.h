@@ -0,0 +1,35 @@
+#ifndef ASSEMBLER_CONTROL_FLOW_H_
+#define ASSEMBLER_CONTROL_FLOW_H_
+
+#include <vector>
+
+#include "assembler/parser.h"
+
+namespace hack {
+
+struct ControlFlowStats {
+  // Jumps retargeted past blocks that only jump on.
+  int jumps_threaded = 0;
+
+  // Basic blocks dropped because nothing reaches them.
+  int blocks_removed = 0;
+
+  // Instructions in those blocks. Labels are not counted.
+  int instructions_removed = 0;
+};
+
+// Splits `program` into basic blocks at labels and jumps, threads each jump
+// that lands on a block consisting of just "@L, 0;JMP" straight to L, then
+// removes every block that cannot be reached from address 0.
+//
+// A jump is direct if it immediately follows the A-instruction that loads its
+// label. A label loaded for any other use, such as a return address, has its
+// address taken, and every indirect jump is assumed to target one of those.
+// The program is left unchanged if that cannot hold, i.e. if a jump loads an
+// address other than a label, such as @100, or if the program jumps indirectly
+// without taking any addresses.
+ControlFlowStats SimplifyControlFlow(std::vector<Instruction>& program);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_CONTROL_FLOW_H_
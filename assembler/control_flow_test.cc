@@ -0,0 +1,150 @@
+#include "assembler/control_flow.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/parser.h"
+
+namespace hack {
+namespace {
+
+// Formats `program` back into assembly, one instruction per line.
+std::string ToAssembly(const std::vector<Instruction>& program) {
+  std::string assembly;
+  for (const Instruction& instruction : program) {
+    assembly += FormatInstruction(instruction) + "\n";
+  }
+  return assembly;
+}
+
+std::string Simplify(std::string_view source,
+                     ControlFlowStats* stats = nullptr) {
+  std::vector<Instruction> program = ParseAll(source);
+  ControlFlowStats result = SimplifyControlFlow(program);
+  if (stats != nullptr) {
+    *stats = result;
+  }
+  return ToAssembly(program);
+}
+
+TEST(ControlFlowTest, ThreadsJumpChains) {
+  ControlFlowStats stats;
+
+  std::string simplified = Simplify(R"asm(
+@A
+D;JGT
+@B
+0;JMP
+(A)
+@B
+0;JMP
+(B)
+@C
+0;JMP
+(C)
+D=1
+(END)
+@END
+0;JMP
+)asm", &stats);
+
+  // Both jumps go straight to C, leaving the trampolines at A and B dead. The
+  // one at A was threaded to C as well before it was removed.
+  EXPECT_EQ(simplified,
+            "@C\nD;JGT\n@C\n0;JMP\n(C)\nD=1\n(END)\n@END\n0;JMP\n");
+  EXPECT_EQ(stats.jumps_threaded, 3);
+  EXPECT_EQ(stats.blocks_removed, 2);
+  EXPECT_EQ(stats.instructions_removed, 4);
+}
+
+TEST(ControlFlowTest, KeepsConditionalJumpWhenFallthroughReadsA) {
+  std::string source = R"asm(
+@A
+D;JGT
+D=A
+(A)
+@END
+0;JMP
+(END)
+@END
+0;JMP
+)asm";
+
+  // Threading would change the A that D=A reads.
+  EXPECT_EQ(Simplify(source), "@A\nD;JGT\nD=A\n(A)\n@END\n0;JMP\n"
+                              "(END)\n@END\n0;JMP\n");
+}
+
+TEST(ControlFlowTest, StopsAtHaltLoop) {
+  ControlFlowStats stats;
+
+  std::string simplified = Simplify("@END\n0;JMP\n(END)\n@END\n0;JMP\n",
+                                    &stats);
+
+  EXPECT_EQ(simplified, "@END\n0;JMP\n(END)\n@END\n0;JMP\n");
+  EXPECT_EQ(stats.jumps_threaded, 0);
+}
+
+TEST(ControlFlowTest, RemovesCodeAfterUnconditionalJump) {
+  ControlFlowStats stats;
+
+  std::string simplified = Simplify(R"asm(
+@END
+0;JMP
+D=M
+M=D
+(DEAD)
+@DEAD
+0;JMP
+(END)
+@END
+0;JMP
+)asm", &stats);
+
+  EXPECT_EQ(simplified, "@END\n0;JMP\n(END)\n@END\n0;JMP\n");
+  EXPECT_EQ(stats.blocks_removed, 2);
+  EXPECT_EQ(stats.instructions_removed, 4);
+}
+
+TEST(ControlFlowTest, KeepsLabelsWhoseAddressIsTaken) {
+  // A call as emitted by the translator: the return label is only reached
+  // through the indirect jump in F.
+  std::string source = R"asm(
+@RET
+D=A
+@R15
+M=D
+@F
+0;JMP
+(RET)
+@END
+0;JMP
+(F)
+@R15
+A=M
+0;JMP
+(END)
+@END
+0;JMP
+)asm";
+
+  EXPECT_EQ(Simplify(source), ToAssembly(ParseAll(source)));
+}
+
+TEST(ControlFlowTest, LeavesProgramsWithNumericJumpsAlone) {
+  std::string source = "@4\n0;JMP\nD=M\n(L)\n@L\n0;JMP\n";
+
+  EXPECT_EQ(Simplify(source), ToAssembly(ParseAll(source)));
+}
+
+TEST(ControlFlowTest, LeavesIndirectJumpsWithoutTakenAddressesAlone) {
+  std::string source = "@R0\nA=M\n0;JMP\nD=M\n(L)\n@L\n0;JMP\n";
+
+  EXPECT_EQ(Simplify(source), ToAssembly(ParseAll(source)));
+}
+
+}  // namespace
+}  // namespace hack
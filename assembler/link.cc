@@ -0,0 +1,57 @@
+#include "assembler/link.h"
+
+#include "assembler/symbol_table.h"
+
+namespace hack {
+
+std::optional<std::vector<uint16_t>> Link(
+    const std::vector<ObjectFile>& objects, std::string* error) {
+  auto symbol_table = SymbolTable::Create();
+  auto defined = SymbolTable::CreateEmpty();
+
+  std::vector<uint32_t> base_addresses;
+  uint32_t num_words = 0;
+  size_t num_labels = 0;
+  for (const ObjectFile& object : objects) {
+    base_addresses.push_back(num_words);
+    num_words += object.words.size();
+    num_labels += object.labels.size();
+  }
+  symbol_table.Reserve(num_labels);
+  defined.Reserve(num_labels);
+
+  for (size_t i = 0; i < objects.size(); i++) {
+    for (const ExportedLabel& label : objects[i].labels) {
+      if (!defined.FindOrInsert(label.symbol, i).second) {
+        *error = "Label '" + label.symbol + "' is defined more than once";
+        return {};
+      }
+      symbol_table.AddEntry(label.symbol, base_addresses[i] + label.address);
+    }
+  }
+
+  std::vector<uint16_t> words;
+  words.reserve(num_words);
+  int next_variable_address = kFirstVariableAddress;
+  for (size_t i = 0; i < objects.size(); i++) {
+    const ObjectFile& object = objects[i];
+    size_t base = words.size();
+    words.insert(words.end(), object.words.begin(), object.words.end());
+
+    for (uint32_t word_index : object.relocations) {
+      words[base + word_index] =
+          (words[base + word_index] + base_addresses[i]) & 0x7fff;
+    }
+    for (const ExternalReference& reference : object.externals) {
+      auto [n, inserted] =
+          symbol_table.FindOrInsert(reference.symbol, next_variable_address);
+      if (inserted) {
+        next_variable_address++;
+      }
+      words[base + reference.word_index] = static_cast<uint16_t>(n) & 0x7fff;
+    }
+  }
+  return words;
+}
+
+}  // namespace hack
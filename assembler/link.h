@@ -0,0 +1,30 @@
+#ifndef ASSEMBLER_LINK_H_
+#define ASSEMBLER_LINK_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "assembler/object_file.h"
+
+namespace hack {
+
+// Links `objects` into a single program, placing them one after another from
+// address 0 in the order given.
+//
+// Every module's labels are visible to every other module. References that
+// match no label resolve to predefined symbols, and anything left is a
+// variable: variables are allocated from address 16 in order of first use,
+// walking the modules in order. Linking the objects of several sources
+// therefore gives exactly the program that assembling their concatenation
+// would.
+//
+// Returns nothing and describes the problem in `error` if a label is defined
+// more than once.
+std::optional<std::vector<uint16_t>> Link(
+    const std::vector<ObjectFile>& objects, std::string* error);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_LINK_H_
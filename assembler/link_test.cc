@@ -0,0 +1,72 @@
+#include "assembler/link.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/assemble.h"
+
+namespace hack {
+namespace {
+
+constexpr std::string_view kMain = R"asm(
+(Main.main)
+@Main.x
+M=0
+@Lib.increment
+0;JMP
+(Main.return)
+@shared
+D=M
+@Main.return
+0;JMP
+)asm";
+
+constexpr std::string_view kLib = R"asm(
+(Lib.increment)
+@shared
+M=M+1
+@Lib.y
+M=D
+@Main.return
+0;JMP
+@SCREEN
+)asm";
+
+TEST(LinkTest, MatchesAssemblingTheConcatenation) {
+  std::string error;
+
+  std::optional<std::vector<uint16_t>> words =
+      Link({AssembleObject(kMain), AssembleObject(kLib)}, &error);
+
+  ASSERT_TRUE(words.has_value()) << error;
+  std::string whole_program = std::string(kMain) + std::string(kLib);
+  EXPECT_EQ(*words, Assemble(whole_program).words);
+}
+
+TEST(LinkTest, ModuleOrderDeterminesLayoutAndVariables) {
+  std::string error;
+
+  std::optional<std::vector<uint16_t>> words =
+      Link({AssembleObject(kLib), AssembleObject(kMain)}, &error);
+
+  ASSERT_TRUE(words.has_value()) << error;
+  std::string whole_program = std::string(kLib) + std::string(kMain);
+  EXPECT_EQ(*words, Assemble(whole_program).words);
+  // @shared is the first variable in this order.
+  EXPECT_EQ((*words)[0], 16);
+}
+
+TEST(LinkTest, DuplicateLabelIsAnError) {
+  std::string error;
+
+  std::optional<std::vector<uint16_t>> words =
+      Link({AssembleObject(kMain), AssembleObject(kMain)}, &error);
+
+  EXPECT_FALSE(words.has_value());
+  EXPECT_EQ(error, "Label 'Main.main' is defined more than once");
+}
+
+}  // namespace
+}  // namespace hack
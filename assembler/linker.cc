@@ -0,0 +1,68 @@
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "assembler/link.h"
+#include "assembler/object_file.h"
+#include "assembler/rom_image.h"
+#include "util/io/mapped_file.h"
+
+using ::hack::Link;
+using ::hack::ObjectFile;
+using ::hack::ReadObjectFile;
+using ::hack::WriteHackText;
+using ::hack::WriteRomImage;
+using ::util_io::MappedFile;
+
+// Links object files written by `assembler --format=object` into a program.
+int main(int argc, char* argv[]) {
+  bool binary_output = false;
+  std::vector<std::filesystem::path> input_paths;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg == "--format=binary") {
+      binary_output = true;
+    } else if (arg == "--format=text") {
+      binary_output = false;
+    } else {
+      input_paths.push_back(std::filesystem::absolute(argv[i]));
+    }
+  }
+  if (input_paths.empty()) {
+    std::cerr << "Usage: linker [--format=text|binary] <object>..."
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<ObjectFile> objects;
+  for (const std::filesystem::path& path : input_paths) {
+    std::optional<MappedFile> input_file = MappedFile::Open(path.string());
+    if (!input_file) {
+      std::cerr << "Could not open '" << path << "'" << std::endl;
+      return 2;
+    }
+    std::optional<ObjectFile> object = ReadObjectFile(input_file->contents());
+    if (!object) {
+      std::cerr << "'" << path << "' is not a valid object file" << std::endl;
+      return 3;
+    }
+    objects.push_back(std::move(*object));
+  }
+
+  std::string error;
+  std::optional<std::vector<uint16_t>> words = Link(objects, &error);
+  if (!words) {
+    std::cerr << error << std::endl;
+    return 4;
+  }
+  if (binary_output) {
+    WriteRomImage(*words, std::cout);
+  } else {
+    WriteHackText(*words, std::cout);
+  }
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+#include "assembler/listing.h"
+
+#include <ctype.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+namespace hack {
+
+namespace {
+
+enum class SymbolKind {
+  kPredefined,
+  kLabel,
+  kVariable
+};
+
+constexpr std::string_view kSymbolKindNames[] = {
+  "predefined", "label", "variable"
+};
+
+struct ListedSymbol {
+  SymbolKind kind;
+
+  int value;
+
+  std::string_view name;
+
+  bool operator<(const ListedSymbol& other) const {
+    return std::tie(kind, value, name) <
+        std::tie(other.kind, other.value, other.name);
+  }
+};
+
+// Width of the address and word columns, including the spaces after them.
+constexpr size_t kPrefixWidth = 17;
+
+bool IsConstant(std::string_view symbol) {
+  return !symbol.empty() && isdigit(symbol[0]);
+}
+
+}  // namespace
+
+void WriteListing(const std::vector<Instruction>& program,
+                  const std::vector<uint16_t>& words,
+                  const SymbolTable& symbols, util_io::OutputSink& output) {
+  output.Write("// address  word  instruction\n");
+  std::unordered_set<std::string_view> labels;
+  size_t address = 0;
+  char prefix[32];
+  for (const Instruction& instruction : program) {
+    std::string line;
+    if (instruction.instruction_type == InstructionType::kLInstruction) {
+      labels.insert(instruction.symbol);
+      line = std::string(kPrefixWidth, ' ') + FormatInstruction(instruction) +
+          "  // = " + std::to_string(symbols.Get(instruction.symbol));
+    } else {
+      snprintf(prefix, sizeof(prefix), "%9zu  %04X  ", address,
+               address < words.size() ? words[address] : 0);
+      line = prefix + FormatInstruction(instruction);
+      if (instruction.instruction_type == InstructionType::kAInstruction &&
+          !IsConstant(instruction.symbol)) {
+        line += "  // = " + std::to_string(symbols.Get(instruction.symbol));
+      }
+      address++;
+    }
+    line += '\n';
+    output.Write(line);
+  }
+
+  std::unordered_set<std::string_view> predefined;
+  for (const auto& [symbol, value] : kPredefinedSymbols) {
+    predefined.insert(symbol);
+  }
+  std::vector<ListedSymbol> listed;
+  listed.reserve(symbols.size());
+  symbols.ForEach([&](std::string_view symbol, int value) {
+    SymbolKind kind = SymbolKind::kVariable;
+    if (labels.count(symbol) != 0) {
+      kind = SymbolKind::kLabel;
+    } else if (predefined.count(symbol) != 0) {
+      kind = SymbolKind::kPredefined;
+    }
+    listed.push_back({kind, value, symbol});
+  });
+  std::sort(listed.begin(), listed.end());
+
+  output.Write("// value  kind  symbol\n");
+  for (const ListedSymbol& symbol : listed) {
+    snprintf(prefix, sizeof(prefix), "%9d  ", symbol.value);
+    std::string line = prefix;
+    line += kSymbolKindNames[static_cast<int>(symbol.kind)];
+    line += "  ";
+    line += symbol.name;
+    line += '\n';
+    output.Write(line);
+  }
+}
+
+}  // namespace hack
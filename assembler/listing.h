@@ -0,0 +1,30 @@
+#ifndef ASSEMBLER_LISTING_H_
+#define ASSEMBLER_LISTING_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "assembler/parser.h"
+#include "assembler/symbol_table.h"
+#include "util/io/output_sink.h"
+
+namespace hack {
+
+// Writes a human-readable listing of an assembled program to `output`.
+//
+// There is one line per instruction, giving its ROM address, its word in hex
+// and the instruction. A symbolic A-instruction also gets the value its symbol
+// resolved to. A label gets a line with no address or word. After the
+// instructions comes the final symbol table, one symbol per line with its
+// value and whether it is predefined, a label or a variable. The symbols are
+// sorted by kind, then value, then name. Lines starting with "//" are headings.
+//
+// `program` is the parsed program that `words` was assembled from, and
+// `symbols` is its final symbol table.
+void WriteListing(const std::vector<Instruction>& program,
+                  const std::vector<uint16_t>& words,
+                  const SymbolTable& symbols, util_io::OutputSink& output);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_LISTING_H_
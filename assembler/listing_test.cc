@@ -0,0 +1,76 @@
+#include "assembler/listing.h"
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "assembler/assemble.h"
+#include "util/io/output_sink.h"
+
+namespace hack {
+namespace {
+
+std::string Listing(std::string_view source) {
+  AssemblyOptions options;
+  options.keep_program = true;
+  AssemblyResult result = Assemble(source, options);
+  std::ostringstream output;
+  {
+    util_io::OutputSink sink(output);
+    WriteListing(result.program, result.words, result.symbols, sink);
+  }
+  return output.str();
+}
+
+TEST(ListingTest, ListsInstructionsWithResolvedSymbols) {
+  std::string listing = Listing("@i\nM=1\n(LOOP)\n@LOOP\nD;JGT\n@5\n");
+
+  EXPECT_EQ(listing.substr(0, listing.find("// value")),
+            "// address  word  instruction\n"
+            "        0  0010  @i  // = 16\n"
+            "        1  EFC8  M=1\n"
+            "                 (LOOP)  // = 2\n"
+            "        2  0002  @LOOP  // = 2\n"
+            "        3  E301  D;JGT\n"
+            "        4  0005  @5\n");
+}
+
+TEST(ListingTest, EndsWithSymbolTableSortedByKind) {
+  std::string listing = Listing("(END)\n@x\n@y\n@END\n0;JMP\n");
+
+  std::string symbols = listing.substr(listing.find("// value"));
+  EXPECT_EQ(symbols.substr(0, symbols.find("       16  variable")),
+            "// value  kind  symbol\n"
+            "        0  predefined  R0\n"
+            "        0  predefined  SP\n"
+            "        1  predefined  LCL\n"
+            "        1  predefined  R1\n"
+            "        2  predefined  ARG\n"
+            "        2  predefined  R2\n"
+            "        3  predefined  R3\n"
+            "        3  predefined  THIS\n"
+            "        4  predefined  R4\n"
+            "        4  predefined  THAT\n"
+            "        5  predefined  R5\n"
+            "        6  predefined  R6\n"
+            "        7  predefined  R7\n"
+            "        8  predefined  R8\n"
+            "        9  predefined  R9\n"
+            "       10  predefined  R10\n"
+            "       11  predefined  R11\n"
+            "       12  predefined  R12\n"
+            "       13  predefined  R13\n"
+            "       14  predefined  R14\n"
+            "       15  predefined  R15\n"
+            "    16384  predefined  SCREEN\n"
+            "    24576  predefined  KBD\n"
+            "        0  label  END\n");
+  EXPECT_NE(listing.find("       16  variable  x\n"
+                         "       17  variable  y\n"),
+            std::string::npos);
+}
+
+}  // namespace
+}  // namespace hack
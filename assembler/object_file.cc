@@ -0,0 +1,191 @@
+#include "assembler/object_file.h"
+
+#include <ctype.h>
+
+#include <charconv>
+
+#include "assembler/code.h"
+#include "assembler/parser.h"
+#include "assembler/symbol_table.h"
+#include "util/io/little_endian.h"
+
+namespace hack {
+
+using ::util_io::GetUint16;
+using ::util_io::GetUint32;
+using ::util_io::PutUint16;
+using ::util_io::PutUint32;
+
+namespace {
+
+void PutString(std::string& out, std::string_view s) {
+  PutUint32(out, s.size());
+  out.append(s);
+}
+
+// Reads fields from an object file, tracking whether it ran out of data.
+class Reader final {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool ok() const {
+    return ok_;
+  }
+
+  bool AtEnd() const {
+    return data_.empty();
+  }
+
+  std::string_view Take(size_t n) {
+    if (!ok_ || data_.size() < n) {
+      ok_ = false;
+      return {};
+    }
+    std::string_view taken = data_.substr(0, n);
+    data_.remove_prefix(n);
+    return taken;
+  }
+
+  uint16_t Uint16() {
+    std::string_view bytes = Take(2);
+    return ok_ ? GetUint16(bytes.data()) : 0;
+  }
+
+  uint32_t Uint32() {
+    std::string_view bytes = Take(4);
+    return ok_ ? GetUint32(bytes.data()) : 0;
+  }
+
+  std::string String() {
+    return std::string(Take(Uint32()));
+  }
+
+ private:
+  std::string_view data_;
+
+  bool ok_ = true;
+};
+
+}  // namespace
+
+ObjectFile AssembleObject(std::string_view source) {
+  ObjectFile object;
+  auto labels = SymbolTable::CreateEmpty();
+
+  // Any symbol may be a forward reference to a label in this module, so all of
+  // them are resolved once the whole module has been seen.
+  std::vector<ExternalReference> references;
+  Parser parser(source);
+  while (parser.HasMoreLines()) {
+    parser.Advance();
+    const Instruction& instruction = parser.CurrentInstruction();
+    switch (instruction.instruction_type) {
+      case InstructionType::kLInstruction:
+        labels.AddEntry(instruction.symbol, object.words.size());
+        object.labels.push_back(
+            {std::string(instruction.symbol),
+             static_cast<uint32_t>(object.words.size())});
+        break;
+
+      case InstructionType::kAInstruction: {
+        std::string_view symbol = instruction.symbol;
+        int n = 0;
+        if (!symbol.empty() && isdigit(symbol[0])) {
+          std::from_chars(symbol.data(), symbol.data() + symbol.size(), n);
+        } else {
+          references.push_back({static_cast<uint32_t>(object.words.size()),
+                                std::string(symbol)});
+        }
+        object.words.push_back(static_cast<uint16_t>(n) & 0x7fff);
+        break;
+      }
+
+      case InstructionType::kCInstruction:
+        object.words.push_back(EncodeCInstruction(instruction.destination,
+                                                  instruction.comparison,
+                                                  instruction.jump));
+        break;
+    }
+  }
+
+  for (ExternalReference& reference : references) {
+    int address = labels.Get(reference.symbol);
+    if (address >= 0) {
+      object.words[reference.word_index] = address;
+      object.relocations.push_back(reference.word_index);
+    } else {
+      object.externals.push_back(std::move(reference));
+    }
+  }
+  return object;
+}
+
+void WriteObjectFile(const ObjectFile& object, std::ostream& output) {
+  std::string data;
+  data.append(kObjectFileMagic);
+  PutUint16(data, kObjectFileVersion);
+
+  PutUint32(data, object.words.size());
+  for (uint16_t word : object.words) {
+    PutUint16(data, word);
+  }
+  PutUint32(data, object.labels.size());
+  for (const ExportedLabel& label : object.labels) {
+    PutString(data, label.symbol);
+    PutUint32(data, label.address);
+  }
+  PutUint32(data, object.relocations.size());
+  for (uint32_t word_index : object.relocations) {
+    PutUint32(data, word_index);
+  }
+  PutUint32(data, object.externals.size());
+  for (const ExternalReference& reference : object.externals) {
+    PutUint32(data, reference.word_index);
+    PutString(data, reference.symbol);
+  }
+
+  output.write(data.data(), data.size());
+}
+
+std::optional<ObjectFile> ReadObjectFile(std::string_view data) {
+  Reader reader(data);
+  if (reader.Take(kObjectFileMagic.size()) != kObjectFileMagic ||
+      reader.Uint16() != kObjectFileVersion) {
+    return {};
+  }
+
+  // Counts are checked against the remaining data as it is consumed, so a
+  // corrupt count fails cleanly rather than allocating a huge vector.
+  ObjectFile object;
+  for (uint32_t n = reader.Uint32(); reader.ok() && n > 0; n--) {
+    object.words.push_back(reader.Uint16());
+  }
+  for (uint32_t n = reader.Uint32(); reader.ok() && n > 0; n--) {
+    std::string symbol = reader.String();
+    object.labels.push_back({std::move(symbol), reader.Uint32()});
+  }
+  for (uint32_t n = reader.Uint32(); reader.ok() && n > 0; n--) {
+    object.relocations.push_back(reader.Uint32());
+  }
+  for (uint32_t n = reader.Uint32(); reader.ok() && n > 0; n--) {
+    uint32_t word_index = reader.Uint32();
+    object.externals.push_back({word_index, reader.String()});
+  }
+  if (!reader.ok() || !reader.AtEnd()) {
+    return {};
+  }
+
+  for (uint32_t word_index : object.relocations) {
+    if (word_index >= object.words.size()) {
+      return {};
+    }
+  }
+  for (const ExternalReference& reference : object.externals) {
+    if (reference.word_index >= object.words.size()) {
+      return {};
+    }
+  }
+  return object;
+}
+
+}  // namespace hack
@@ -0,0 +1,60 @@
+#ifndef ASSEMBLER_OBJECT_FILE_H_
+#define ASSEMBLER_OBJECT_FILE_H_
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hack {
+
+// A label defined by a module.
+struct ExportedLabel {
+  std::string symbol;
+
+  // Address of the label relative to the start of the module.
+  uint32_t address;
+};
+
+// An A-instruction naming a symbol the module does not define. The linker
+// resolves it to another module's label, a predefined symbol or, failing
+// both, a variable.
+struct ExternalReference {
+  uint32_t word_index;
+
+  std::string symbol;
+};
+
+// A separately assembled module. Words that refer to the module's own labels
+// hold module-relative addresses and are listed in `relocations`; words that
+// refer to other symbols hold zero and are listed in `externals`.
+struct ObjectFile {
+  std::vector<uint16_t> words;
+
+  std::vector<ExportedLabel> labels;
+
+  // Indices of words that must have the module's base address added.
+  std::vector<uint32_t> relocations;
+
+  // In the order they appear in the module.
+  std::vector<ExternalReference> externals;
+};
+
+// Object files start with this magic, followed by a uint16 format version.
+constexpr std::string_view kObjectFileMagic = "HOBJ";
+constexpr uint16_t kObjectFileVersion = 1;
+
+// Assembles `source` into a relocatable module.
+ObjectFile AssembleObject(std::string_view source);
+
+// Writes `object` to `output` in the binary object file format.
+void WriteObjectFile(const ObjectFile& object, std::ostream& output);
+
+// Decodes a binary object file. Returns nothing if it is malformed.
+std::optional<ObjectFile> ReadObjectFile(std::string_view data);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_OBJECT_FILE_H_
@@ -0,0 +1,75 @@
+#include "assembler/object_file.h"
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace hack {
+namespace {
+
+constexpr std::string_view kModule = R"asm(
+(Main.main)
+@Main.loop
+0;JMP
+(Main.loop)
+@counter
+M=M+1
+@Other.function
+0;JMP
+@SP
+@7
+)asm";
+
+TEST(ObjectFileTest, AssembleObjectSeparatesLocalAndExternalSymbols) {
+  ObjectFile object = AssembleObject(kModule);
+
+  ASSERT_EQ(object.words.size(), 8);
+  EXPECT_EQ(object.words[0], 2);
+  EXPECT_EQ(object.words[7], 7);
+  ASSERT_EQ(object.labels.size(), 2);
+  EXPECT_EQ(object.labels[0].symbol, "Main.main");
+  EXPECT_EQ(object.labels[0].address, 0);
+  EXPECT_EQ(object.labels[1].symbol, "Main.loop");
+  EXPECT_EQ(object.labels[1].address, 2);
+  EXPECT_EQ(object.relocations, std::vector<uint32_t>({0}));
+  ASSERT_EQ(object.externals.size(), 3);
+  EXPECT_EQ(object.externals[0].word_index, 2);
+  EXPECT_EQ(object.externals[0].symbol, "counter");
+  EXPECT_EQ(object.externals[1].symbol, "Other.function");
+  EXPECT_EQ(object.externals[2].symbol, "SP");
+}
+
+TEST(ObjectFileTest, RoundTrips) {
+  ObjectFile object = AssembleObject(kModule);
+  std::ostringstream output;
+
+  WriteObjectFile(object, output);
+  std::optional<ObjectFile> read = ReadObjectFile(output.str());
+
+  ASSERT_TRUE(read.has_value());
+  EXPECT_EQ(read->words, object.words);
+  EXPECT_EQ(read->relocations, object.relocations);
+  ASSERT_EQ(read->labels.size(), object.labels.size());
+  EXPECT_EQ(read->labels[1].symbol, object.labels[1].symbol);
+  EXPECT_EQ(read->labels[1].address, object.labels[1].address);
+  ASSERT_EQ(read->externals.size(), object.externals.size());
+  EXPECT_EQ(read->externals[1].symbol, object.externals[1].symbol);
+  EXPECT_EQ(read->externals[1].word_index, object.externals[1].word_index);
+}
+
+TEST(ObjectFileTest, RejectsTruncatedFile) {
+  std::ostringstream output;
+  WriteObjectFile(AssembleObject(kModule), output);
+  std::string data = output.str();
+  data.pop_back();
+
+  EXPECT_FALSE(ReadObjectFile(data).has_value());
+}
+
+TEST(ObjectFileTest, RejectsRomImage) {
+  EXPECT_FALSE(ReadObjectFile("HROM\x01\x00").has_value());
+}
+
+}  // namespace
+}  // namespace hack
@@ -0,0 +1,473 @@
+#include "assembler/outline.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace hack {
+
+namespace {
+
+// @RET, D=A, @R14, M=D, @SUBROUTINE, 0;JMP, (RET)
+constexpr int kCallWords = 6;
+
+// @R14, A=M, 0;JMP
+constexpr int kReturnWords = 3;
+
+// @SUBROUTINE, 0;JMP
+constexpr int kTailCallWords = 2;
+
+// Nothing shorter can be outlined profitably.
+constexpr int kMinLength = kTailCallWords + 1;
+
+constexpr std::string_view kLabelPrefix = "__outlined";
+
+// How an instruction first touches a register.
+enum class Access { kNone, kRead, kWrite };
+
+Access AccessesA(const Instruction& instruction) {
+  switch (instruction.instruction_type) {
+    case InstructionType::kAInstruction:
+      return Access::kWrite;
+    case InstructionType::kLInstruction:
+      return Access::kRead;
+    case InstructionType::kCInstruction:
+      break;
+  }
+  // Writing M and jumping both use A as an address.
+  if (instruction.comparison.find_first_of("AM") != std::string_view::npos ||
+      instruction.destination.find('M') != std::string_view::npos ||
+      !instruction.jump.empty()) {
+    return Access::kRead;
+  }
+  if (instruction.destination.find('A') != std::string_view::npos) {
+    return Access::kWrite;
+  }
+  return Access::kNone;
+}
+
+Access AccessesD(const Instruction& instruction) {
+  switch (instruction.instruction_type) {
+    case InstructionType::kAInstruction:
+      return Access::kNone;
+    case InstructionType::kLInstruction:
+      return Access::kRead;
+    case InstructionType::kCInstruction:
+      break;
+  }
+  if (instruction.comparison.find('D') != std::string_view::npos) {
+    return Access::kRead;
+  }
+  if (instruction.destination.find('D') != std::string_view::npos) {
+    return Access::kWrite;
+  }
+  return Access::kNone;
+}
+
+bool IsUnconditionalJump(const Instruction& instruction) {
+  return instruction.instruction_type == InstructionType::kCInstruction &&
+      instruction.comparison == "0" && instruction.jump == "JMP";
+}
+
+// Returns the address of a register named like R14 or 14, or -1.
+int RegisterAddress(std::string_view name) {
+  if (!name.empty() && name[0] == 'R') {
+    name.remove_prefix(1);
+  }
+  int address;
+  auto [end, error] =
+      std::from_chars(name.data(), name.data() + name.size(), address);
+  if (error != std::errc() || end != name.data() + name.size()) {
+    return -1;
+  }
+  return address;
+}
+
+// Per-instruction facts that do not change while outlining.
+struct Analysis {
+  // Identical instructions share an id.
+  std::vector<uint64_t> ids;
+
+  // Labels, jumps and uses of the return register can only end a sequence,
+  // and only if they are unconditional jumps.
+  std::vector<bool> barrier;
+
+  // Index of the first instruction at or after each one that touches A or D,
+  // or the program size if none does.
+  std::vector<int> next_a;
+  std::vector<int> next_d;
+};
+
+Analysis Analyze(const std::vector<Instruction>& program,
+                 std::string_view return_register) {
+  int n = program.size();
+  int return_address = RegisterAddress(return_register);
+  Analysis analysis;
+  analysis.ids.resize(n);
+  analysis.barrier.resize(n);
+  analysis.next_a.resize(n + 1, n);
+  analysis.next_d.resize(n + 1, n);
+
+  std::unordered_map<std::string, uint64_t> ids;
+  std::string key;
+  for (int i = 0; i < n; i++) {
+    const Instruction& instruction = program[i];
+    key.clear();
+    key += static_cast<char>(instruction.instruction_type);
+    key.append(instruction.symbol).append("|");
+    key.append(instruction.destination).append("|");
+    key.append(instruction.comparison).append("|");
+    key.append(instruction.jump);
+    analysis.ids[i] = ids.emplace(key, ids.size() + 1).first->second;
+
+    bool uses_return_register =
+        instruction.instruction_type == InstructionType::kAInstruction &&
+        (instruction.symbol == return_register ||
+         (return_address >= 0 &&
+          RegisterAddress(instruction.symbol) == return_address));
+    analysis.barrier[i] =
+        instruction.instruction_type == InstructionType::kLInstruction ||
+        !instruction.jump.empty() || uses_return_register;
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    analysis.next_a[i] = AccessesA(program[i]) == Access::kNone
+        ? analysis.next_a[i + 1] : i;
+    analysis.next_d[i] = AccessesD(program[i]) == Access::kNone
+        ? analysis.next_d[i + 1] : i;
+  }
+  return analysis;
+}
+
+struct Subroutine {
+  // The first occurrence in the original program, which becomes the body.
+  int start;
+  int length;
+
+  // Ends with an unconditional jump, so it is jumped to rather than called.
+  bool tail;
+
+  std::string_view label;
+};
+
+// A repeated sequence that may be worth outlining.
+struct Candidate {
+  int length;
+
+  // Non-overlapping starts of identical sequences, in order.
+  std::vector<int> starts;
+};
+
+// How outlining `count` copies of a sequence changes the program size.
+int WordsSaved(int length, int count, bool tail) {
+  int call_words = tail ? kTailCallWords : kCallWords;
+  int body_words = length + (tail ? 0 : kReturnWords);
+  return count * (length - call_words) - body_words;
+}
+
+class Outliner {
+ public:
+  Outliner(const std::vector<Instruction>& program,
+           const OutlineOptions& options)
+      : program_(program), options_(options),
+        analysis_(Analyze(program, options.return_register)),
+        call_at_(program.size(), -1) {}
+
+  // Outlines candidates greedily, most words saved first. A candidate's
+  // saving only shrinks as other candidates claim its copies, so it is
+  // re-evaluated when it reaches the front of the queue and requeued if it
+  // dropped.
+  void Run(OutlineStats& stats) {
+    std::vector<Candidate> candidates = FindCandidates();
+
+    // (words saved, length, -first start, candidate index)
+    using Entry = std::tuple<int, int, int, int>;
+    std::priority_queue<Entry> queue;
+    for (size_t i = 0; i < candidates.size(); i++) {
+      const Candidate& candidate = candidates[i];
+      int words_saved = WordsSaved(candidate.length, candidate.starts.size(),
+                                   IsTail(candidate));
+      if (words_saved >= options_.min_words_saved) {
+        queue.emplace(words_saved, candidate.length, -candidate.starts[0], i);
+      }
+    }
+
+    std::vector<int> starts;
+    while (!queue.empty()) {
+      auto [queued_saving, length, first_start, index] = queue.top();
+      queue.pop();
+      Candidate& candidate = candidates[index];
+
+      starts.clear();
+      for (int start : candidate.starts) {
+        if (!Claimed(start, length)) {
+          starts.push_back(start);
+        }
+      }
+      bool tail = IsTail(candidate);
+      int words_saved = WordsSaved(length, starts.size(), tail);
+      if (starts.size() < 2 || words_saved < options_.min_words_saved) {
+        continue;
+      }
+      if (words_saved < queued_saving) {
+        candidate.starts = starts;
+        queue.emplace(words_saved, length, -starts[0], index);
+        continue;
+      }
+
+      int subroutine = subroutines_.size();
+      subroutines_.push_back({starts[0], length, tail, {}});
+      for (int start : starts) {
+        claimed_[start] = start + length;
+        call_at_[start] = subroutine;
+      }
+      stats.subroutines++;
+      stats.call_sites += starts.size();
+      stats.words_saved += words_saved;
+      stats.cycles_added +=
+          starts.size() * (tail ? kTailCallWords : kCallWords + kReturnWords);
+    }
+  }
+
+  const std::vector<Subroutine>& subroutines() const { return subroutines_; }
+
+  // The subroutine whose call replaces the sequence starting at each index,
+  // or -1.
+  const std::vector<int>& call_at() const { return call_at_; }
+
+ private:
+  static constexpr uint64_t kHashBase = 0x100000001b3;
+
+  bool IsTail(const Candidate& candidate) const {
+    return IsUnconditionalJump(
+        program_[candidate.starts[0] + candidate.length - 1]);
+  }
+
+  // Returns true if [start, start + length) may be replaced by a call.
+  // `barriers` counts barriers before each index.
+  bool CanOutline(int start, int length,
+                  const std::vector<int>& barriers) const {
+    int last = start + length - 1;
+    if (barriers[last] != barriers[start]) {
+      return false;
+    }
+    bool tail = IsUnconditionalJump(program_[last]);
+    if (analysis_.barrier[last] && !tail) {
+      return false;
+    }
+
+    // The call clobbers A, so the sequence must set A before reading it.
+    int a = analysis_.next_a[start];
+    if (a <= last && AccessesA(program_[a]) != Access::kWrite) {
+      return false;
+    }
+    if (tail) {
+      return true;
+    }
+
+    // It also clobbers D, and nothing restores it, so the sequence must set D
+    // before reading it. The return clobbers A, so the next instruction must
+    // set it. Every call starts by setting A, so that still holds if the next
+    // instruction is later outlined too.
+    int d = analysis_.next_d[start];
+    int next = last + 1;
+    return d <= last && AccessesD(program_[d]) == Access::kWrite &&
+        next < static_cast<int>(program_.size()) &&
+        program_[next].instruction_type == InstructionType::kAInstruction;
+  }
+
+  bool SameSequence(int a, int b, int length) const {
+    for (int i = 0; i < length; i++) {
+      if (analysis_.ids[a + i] != analysis_.ids[b + i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns true if [start, start + length) overlaps an outlined sequence.
+  bool Claimed(int start, int length) const {
+    auto next = claimed_.lower_bound(start + length);
+    return next != claimed_.begin() && std::prev(next)->second > start;
+  }
+
+  // Groups identical outlinable sequences of every length by hashing them.
+  std::vector<Candidate> FindCandidates() const {
+    int n = program_.size();
+    std::vector<uint64_t> prefix_hash(n + 1);
+    std::vector<int> barriers(n + 1);
+    for (int i = 0; i < n; i++) {
+      prefix_hash[i + 1] = prefix_hash[i] * kHashBase + analysis_.ids[i];
+      barriers[i + 1] = barriers[i] + (analysis_.barrier[i] ? 1 : 0);
+    }
+
+    std::vector<Candidate> candidates;
+    std::unordered_map<uint64_t, int> group_of_hash;
+    std::vector<std::vector<int>> groups;
+    uint64_t power = 1;
+    for (int length = 1; length <= std::min(options_.max_length, n);
+         length++) {
+      power *= kHashBase;
+      if (length < kMinLength) {
+        continue;
+      }
+
+      group_of_hash.clear();
+      groups.clear();
+      for (int start = 0; start + length <= n; start++) {
+        if (!CanOutline(start, length, barriers)) {
+          continue;
+        }
+        uint64_t hash =
+            prefix_hash[start + length] - prefix_hash[start] * power;
+        auto [it, inserted] = group_of_hash.emplace(hash, groups.size());
+        if (inserted) {
+          groups.emplace_back();
+        }
+        groups[it->second].push_back(start);
+      }
+
+      for (const std::vector<int>& group : groups) {
+        if (group.size() < 2) {
+          continue;
+        }
+        Candidate candidate{length, {}};
+        for (int start : group) {
+          if (SameSequence(group[0], start, length) &&
+              (candidate.starts.empty() ||
+               start >= candidate.starts.back() + length)) {
+            candidate.starts.push_back(start);
+          }
+        }
+        if (candidate.starts.size() >= 2) {
+          candidates.push_back(std::move(candidate));
+        }
+      }
+    }
+    return candidates;
+  }
+
+  const std::vector<Instruction>& program_;
+
+  const OutlineOptions& options_;
+
+  const Analysis analysis_;
+
+  // The end of each outlined sequence, by start.
+  std::map<int, int> claimed_;
+
+  std::vector<int> call_at_;
+
+  std::vector<Subroutine> subroutines_;
+};
+
+// Returns a label prefix that no symbol in `program` starts with.
+std::string UniqueLabelPrefix(const std::vector<Instruction>& program) {
+  std::string prefix(kLabelPrefix);
+  std::unordered_set<std::string_view> symbols;
+  for (const Instruction& instruction : program) {
+    if (instruction.instruction_type != InstructionType::kCInstruction) {
+      symbols.insert(instruction.symbol);
+    }
+  }
+  for (;;) {
+    bool clashes = false;
+    for (std::string_view symbol : symbols) {
+      if (symbol.substr(0, prefix.size()) == prefix) {
+        clashes = true;
+        break;
+      }
+    }
+    if (!clashes) {
+      return prefix;
+    }
+    prefix += "_";
+  }
+}
+
+Instruction AInstruction(std::string_view symbol) {
+  return {InstructionType::kAInstruction, symbol, "", "", ""};
+}
+
+Instruction Label(std::string_view symbol) {
+  return {InstructionType::kLInstruction, symbol, "", "", ""};
+}
+
+Instruction CInstruction(std::string_view dest, std::string_view comp,
+                         std::string_view jump = "") {
+  return {InstructionType::kCInstruction, "", dest, comp, jump};
+}
+
+}  // namespace
+
+OutlineStats OutlineRepeatedSequences(std::vector<Instruction>& program,
+                                      std::deque<std::string>& names,
+                                      const OutlineOptions& options) {
+  OutlineStats stats;
+  if (program.empty() || !IsUnconditionalJump(program.back())) {
+    return stats;
+  }
+
+  Outliner outliner(program, options);
+  outliner.Run(stats);
+  if (stats.subroutines == 0) {
+    return stats;
+  }
+
+  std::string_view return_register =
+      names.emplace_back(options.return_register);
+  std::string prefix = UniqueLabelPrefix(program);
+  std::vector<Subroutine> subroutines = outliner.subroutines();
+  for (size_t i = 0; i < subroutines.size(); i++) {
+    subroutines[i].label =
+        names.emplace_back(prefix + "." + std::to_string(i));
+  }
+
+  std::vector<Instruction> output;
+  output.reserve(program.size());
+  const std::vector<int>& call_at = outliner.call_at();
+  int return_count = 0;
+  for (size_t i = 0; i < program.size();) {
+    if (call_at[i] < 0) {
+      output.push_back(program[i++]);
+      continue;
+    }
+    const Subroutine& subroutine = subroutines[call_at[i]];
+    if (subroutine.tail) {
+      output.push_back(AInstruction(subroutine.label));
+      output.push_back(CInstruction("", "0", "JMP"));
+    } else {
+      std::string_view return_label = names.emplace_back(
+          prefix + ".ret." + std::to_string(return_count++));
+      output.push_back(AInstruction(return_label));
+      output.push_back(CInstruction("D", "A"));
+      output.push_back(AInstruction(return_register));
+      output.push_back(CInstruction("M", "D"));
+      output.push_back(AInstruction(subroutine.label));
+      output.push_back(CInstruction("", "0", "JMP"));
+      output.push_back(Label(return_label));
+    }
+    i += subroutine.length;
+  }
+
+  for (const Subroutine& subroutine : subroutines) {
+    output.push_back(Label(subroutine.label));
+    output.insert(output.end(), program.begin() + subroutine.start,
+                  program.begin() + subroutine.start + subroutine.length);
+    if (!subroutine.tail) {
+      output.push_back(AInstruction(return_register));
+      output.push_back(CInstruction("A", "M"));
+      output.push_back(CInstruction("", "0", "JMP"));
+    }
+  }
+
+  program.swap(output);
+  return stats;
+}
+
+}  // namespace hack
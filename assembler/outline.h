@@ -0,0 +1,65 @@
+#ifndef ASSEMBLER_OUTLINE_H_
+#define ASSEMBLER_OUTLINE_H_
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "assembler/parser.h"
+
+namespace hack {
+
+struct OutlineOptions {
+  // RAM register that holds the return address while an outlined subroutine
+  // runs. The program must not otherwise use it.
+  std::string_view return_register = "R14";
+
+  // Only outline a sequence if doing so saves at least this many words.
+  // Raising it trades ROM size for speed.
+  int min_words_saved = 1;
+
+  // Longest sequence considered, in instructions.
+  int max_length = 64;
+};
+
+struct OutlineStats {
+  // Subroutines created.
+  int subroutines = 0;
+
+  // Sequences replaced by a call to a subroutine.
+  int call_sites = 0;
+
+  // ROM words saved after accounting for calls and returns.
+  int words_saved = 0;
+
+  // Extra instructions executed if every call site runs once.
+  int cycles_added = 0;
+
+  int bytes_saved() const { return 2 * words_saved; }
+};
+
+// Replaces straight-line instruction sequences that occur more than once in
+// `program` with calls to a single copy, appended at the end of the program.
+//
+// A call stores its return label in `return_register` and jumps to the copy,
+// which jumps back through it: 6 extra words per call site, 3 per copy and 9
+// extra cycles per call. A sequence that already ends with an unconditional
+// jump is instead jumped to directly, for 2 words and 2 cycles per call site.
+// Sequences are only outlined when A and D on entry are not read and, for
+// calls, when A is not read on return, so the clobbered registers never
+// matter.
+//
+// As with OptimizePeephole, this assumes that jumps target labels. It does
+// nothing unless the program ends with an unconditional jump, so control
+// never falls through into the appended subroutines. The names of new labels
+// are stored in `names`, which must outlive `program`. Variables first used in
+// an outlined sequence move unless the result is assembled with the original
+// program as the variable order; see AssembleInstructions.
+OutlineStats OutlineRepeatedSequences(std::vector<Instruction>& program,
+                                      std::deque<std::string>& names,
+                                      const OutlineOptions& options = {});
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_OUTLINE_H_
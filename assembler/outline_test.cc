@@ -0,0 +1,205 @@
+#include "assembler/outline.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/assemble.h"
+#include "assembler/parser.h"
+
+namespace hack {
+namespace {
+
+// Runs `rom` from address 0 until it reaches an "@k, 0;JMP" loop at k, and
+// returns the first 32 words of RAM. R14 is cleared since outlined calls use
+// it.
+std::vector<int16_t> RunUntilHalted(const std::vector<uint16_t>& rom) {
+  std::vector<int16_t> ram(1 << 15);
+  int16_t a = 0;
+  int16_t d = 0;
+  for (int pc = 0, steps = 0; pc < static_cast<int>(rom.size()) &&
+                              steps < 100000; steps++) {
+    uint16_t word = rom[pc];
+    if ((word & 0x8000) == 0) {
+      a = word;
+      pc++;
+      continue;
+    }
+    int16_t x = d;
+    int16_t y = (word & 0x1000) ? ram[a & 0x7fff] : a;
+    if (word & 0x0800) x = 0;
+    if (word & 0x0400) x = ~x;
+    if (word & 0x0200) y = 0;
+    if (word & 0x0100) y = ~y;
+    int16_t out = (word & 0x0080) ? static_cast<int16_t>(x + y) : (x & y);
+    if (word & 0x0040) out = ~out;
+
+    // Jumps go to A as it was before this instruction.
+    int16_t address = a;
+    if (word & 0x0020) a = out;
+    if (word & 0x0010) d = out;
+    if (word & 0x0008) ram[address & 0x7fff] = out;
+    bool jump = ((word & 0x4) && out < 0) || ((word & 0x2) && out == 0) ||
+        ((word & 0x1) && out > 0);
+    if (!jump) {
+      pc++;
+    } else if ((word & 0x7) == 0x7 && address == pc - 1) {
+      break;
+    } else {
+      pc = address;
+    }
+  }
+  ram.resize(32);
+  ram[14] = 0;
+  return ram;
+}
+
+// Adds 7 to R5 through the stack.
+constexpr std::string_view kAddSevenToR5 = R"asm(
+@7
+D=A
+@SP
+A=M
+M=D
+@SP
+M=M+1
+@SP
+AM=M-1
+D=M
+@R5
+M=D+M
+)asm";
+
+constexpr std::string_view kHalt = R"asm(
+(END)
+@END
+0;JMP
+)asm";
+
+std::string Repeat(std::string_view text, int times) {
+  std::string repeated;
+  for (int i = 0; i < times; i++) {
+    repeated += text;
+  }
+  return repeated;
+}
+
+// Each copy of kAddSevenToR5 followed by a different instruction.
+std::string AddSevenToR5Program(int copies) {
+  std::string source = "@256\nD=A\n@SP\nM=D\n";
+  for (int i = 0; i < copies; i++) {
+    source += std::string(kAddSevenToR5) + "@" + std::to_string(i) +
+        "\nD=A\n@R6\nM=D+M\n";
+  }
+  return source + std::string(kHalt);
+}
+
+TEST(OutlineTest, CallsRepeatedSequence) {
+  std::string source = AddSevenToR5Program(4);
+  std::vector<Instruction> program = ParseAll(source);
+  std::deque<std::string> names;
+
+  OutlineStats stats = OutlineRepeatedSequences(program, names);
+
+  EXPECT_EQ(stats.subroutines, 1);
+  EXPECT_EQ(stats.call_sites, 4);
+  EXPECT_EQ(stats.words_saved, 4 * (12 - 6) - (12 + 3));
+  EXPECT_EQ(stats.bytes_saved(), 2 * stats.words_saved);
+  EXPECT_EQ(stats.cycles_added, 4 * 9);
+  std::vector<uint16_t> original = Assemble(source).words;
+  std::vector<uint16_t> outlined = AssembleInstructions(program).words;
+  EXPECT_EQ(original.size() - outlined.size(), stats.words_saved);
+  std::vector<int16_t> ram = RunUntilHalted(outlined);
+  EXPECT_EQ(ram[5], 28);
+  EXPECT_EQ(ram, RunUntilHalted(original));
+}
+
+TEST(OutlineTest, OutlinesBackToBackCopies) {
+  std::string source = "@256\nD=A\n@SP\nM=D\n" + Repeat(kAddSevenToR5, 6) +
+      std::string(kHalt);
+  std::vector<Instruction> program = ParseAll(source);
+  std::deque<std::string> names;
+
+  OutlineStats stats = OutlineRepeatedSequences(program, names);
+
+  EXPECT_GT(stats.words_saved, 0);
+  std::vector<uint16_t> original = Assemble(source).words;
+  std::vector<uint16_t> outlined = AssembleInstructions(program).words;
+  EXPECT_EQ(original.size() - outlined.size(), stats.words_saved);
+  EXPECT_EQ(RunUntilHalted(outlined), RunUntilHalted(original));
+}
+
+TEST(OutlineTest, JumpsToRepeatedTail) {
+  std::string tail = "@R13\nD=M\n@R15\nM=D\n@END\n0;JMP\n";
+  std::string source = "@R13\nM=1\n@R15\nM=0\n@END\n0;JMP\n(X0)\n" +
+      tail + "(X1)\n" + tail + "(X2)\n" + tail +
+      std::string(kHalt);
+  std::vector<Instruction> program = ParseAll(source);
+  std::deque<std::string> names;
+
+  OutlineStats stats = OutlineRepeatedSequences(program, names);
+
+  EXPECT_EQ(stats.subroutines, 1);
+  EXPECT_EQ(stats.call_sites, 3);
+  EXPECT_EQ(stats.words_saved, 3 * (6 - 2) - 6);
+  EXPECT_EQ(stats.cycles_added, 3 * 2);
+}
+
+TEST(OutlineTest, KeepsSequencesThatReadDOnEntry) {
+  std::string sequence = "@SP\nA=M\nM=D\n@SP\nM=M+1\n@R6\nD=M\n@R7\nM=D\n";
+  std::string source = Repeat(sequence + "@1\nD=A\n", 5) + std::string(kHalt);
+  std::vector<Instruction> program = ParseAll(source);
+  std::deque<std::string> names;
+
+  OutlineStats stats = OutlineRepeatedSequences(program, names);
+
+  // Only the part after the first D read may be outlined.
+  std::vector<uint16_t> original = Assemble(source).words;
+  std::vector<uint16_t> outlined = AssembleInstructions(program).words;
+  EXPECT_EQ(RunUntilHalted(outlined), RunUntilHalted(original));
+  EXPECT_LE(original.size() - outlined.size(), stats.words_saved);
+}
+
+TEST(OutlineTest, KeepsSequencesUsingTheReturnRegister) {
+  std::string source =
+      Repeat("@3\nD=A\n@R14\nM=D+M\n@R6\nM=D+M\n@R7\nM=D+M\n@R8\nM=D\n", 5) +
+      std::string(kHalt);
+  std::vector<Instruction> program = ParseAll(source);
+  std::deque<std::string> names;
+  OutlineOptions options;
+  options.min_words_saved = 5;
+
+  OutlineStats stats = OutlineRepeatedSequences(program, names, options);
+
+  EXPECT_EQ(stats.subroutines, 0);
+}
+
+TEST(OutlineTest, RequiresProgramToEndWithJump) {
+  std::string source = AddSevenToR5Program(4) + "@0\n";
+  std::vector<Instruction> program = ParseAll(source);
+  std::deque<std::string> names;
+
+  OutlineStats stats = OutlineRepeatedSequences(program, names);
+
+  EXPECT_EQ(stats.subroutines, 0);
+  EXPECT_EQ(program.size(), ParseAll(source).size());
+}
+
+TEST(OutlineTest, MinWordsSavedLimitsOutlining) {
+  std::string source = AddSevenToR5Program(4);
+  std::vector<Instruction> program = ParseAll(source);
+  std::deque<std::string> names;
+  OutlineOptions options;
+  options.min_words_saved = 10;
+
+  OutlineStats stats = OutlineRepeatedSequences(program, names, options);
+
+  EXPECT_EQ(stats.subroutines, 0);
+}
+
+}  // namespace
+}  // namespace hack
@@ -0,0 +1,91 @@
+// Compares ways of writing a 1M instruction program as .hack text.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <bitset>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "assembler/parallel_assembler.h"
+#include "assembler/rom_image.h"
+#include "util/io/output_sink.h"
+
+namespace hack {
+namespace {
+
+constexpr size_t kProgramSize = 1 << 20;
+
+std::vector<uint16_t> MakeProgram() {
+  std::vector<uint16_t> words(kProgramSize);
+  for (size_t i = 0; i < words.size(); i++) {
+    words[i] = i * 0x9e37;
+  }
+  return words;
+}
+
+void SetBytesProcessed(benchmark::State& state) {
+  state.SetBytesProcessed(state.iterations() * kProgramSize *
+                          kHackTextLineLength);
+}
+
+// What the assembler used to do: a std::bitset and std::endl per line.
+void BM_EndlPerLine(benchmark::State& state) {
+  std::vector<uint16_t> words = MakeProgram();
+  std::ofstream output("/dev/null");
+  for (auto _ : state) {
+    for (uint16_t word : words) {
+      output << std::bitset<16>(word) << std::endl;
+    }
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_EndlPerLine)->Unit(benchmark::kMillisecond);
+
+// One unflushed stream write per line.
+void BM_StreamWritePerLine(benchmark::State& state) {
+  std::vector<uint16_t> words = MakeProgram();
+  std::ofstream output("/dev/null");
+  char line[kHackTextLineLength];
+  for (auto _ : state) {
+    for (uint16_t word : words) {
+      EncodeHackTextLine(word, line);
+      output.write(line, sizeof(line));
+    }
+    output.flush();
+  }
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_StreamWritePerLine)->Unit(benchmark::kMillisecond);
+
+void BM_OutputSink(benchmark::State& state) {
+  std::vector<uint16_t> words = MakeProgram();
+  int fd = open("/dev/null", O_WRONLY);
+  util_io::OutputSink output(fd);
+  for (auto _ : state) {
+    WriteHackText(words, output);
+    output.Flush();
+  }
+  close(fd);
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_OutputSink)->Unit(benchmark::kMillisecond);
+
+void BM_OutputSinkParallel(benchmark::State& state) {
+  std::vector<uint16_t> words = MakeProgram();
+  int fd = open("/dev/null", O_WRONLY);
+  util_io::OutputSink output(fd);
+  for (auto _ : state) {
+    WriteHackTextParallel(words, output, state.range(0));
+    output.Flush();
+  }
+  close(fd);
+  SetBytesProcessed(state);
+}
+BENCHMARK(BM_OutputSinkParallel)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace hack
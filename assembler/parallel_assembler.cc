@@ -0,0 +1,232 @@
+#include "assembler/parallel_assembler.h"
+
+#include <ctype.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "assembler/code.h"
+#include "assembler/parser.h"
+#include "assembler/rom_image.h"
+#include "assembler/symbol_table.h"
+
+namespace hack {
+
+namespace {
+
+// A symbolic A-instruction within a chunk.
+struct Reference {
+  // Index of the instruction within its chunk.
+  size_t word_index;
+
+  std::string_view symbol;
+};
+
+// A label definition within a chunk.
+struct Label {
+  std::string_view symbol;
+
+  // Address of the following instruction, relative to the start of the chunk.
+  size_t address;
+};
+
+struct Chunk {
+  std::string_view source;
+
+  // Address of the chunk's first instruction in the whole program.
+  size_t base_address = 0;
+
+  // Encoded instructions. A-instructions holding a symbol are placeholders
+  // until the symbol is resolved.
+  std::vector<uint16_t> words;
+
+  std::vector<Label> labels;
+
+  std::vector<Reference> references;
+
+  // References that are not labels, i.e. variables, in order of use.
+  std::vector<Reference> unresolved;
+};
+
+// Runs `task(i)` for every i in [0, num_tasks) on up to `num_threads` threads.
+// Workers take the next task index from a shared counter, so uneven tasks
+// balance out.
+template <typename Task>
+void RunInParallel(size_t num_tasks, int num_threads, const Task& task) {
+  size_t num_workers = std::min<size_t>(std::max(num_threads, 1), num_tasks);
+  if (num_workers <= 1) {
+    for (size_t i = 0; i < num_tasks; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_task(0);
+  auto worker = [&]() {
+    size_t i;
+    while ((i = next_task.fetch_add(1)) < num_tasks) {
+      task(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_workers; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+// Splits `source` into about `num_chunks` pieces, each ending at a newline.
+std::vector<Chunk> SplitAtLines(std::string_view source, size_t num_chunks) {
+  std::vector<Chunk> chunks;
+  size_t target_size = source.size() / num_chunks + 1;
+  size_t start = 0;
+  while (start < source.size()) {
+    size_t end = std::min(start + target_size, source.size());
+    if (end < source.size()) {
+      size_t newline = source.find('\n', end);
+      end = newline == std::string_view::npos ? source.size() : newline + 1;
+    }
+    Chunk chunk;
+    chunk.source = source.substr(start, end - start);
+    chunks.push_back(std::move(chunk));
+    start = end;
+  }
+  return chunks;
+}
+
+void ParseAndEncode(Chunk& chunk) {
+  Parser parser(chunk.source);
+  chunk.words.reserve(
+      std::count(chunk.source.begin(), chunk.source.end(), '\n') + 1);
+  while (parser.HasMoreLines()) {
+    parser.Advance();
+    const Instruction& instruction = parser.CurrentInstruction();
+    switch (instruction.instruction_type) {
+      case InstructionType::kLInstruction:
+        chunk.labels.push_back({instruction.symbol, chunk.words.size()});
+        break;
+
+      case InstructionType::kAInstruction: {
+        std::string_view symbol = instruction.symbol;
+        int n = 0;
+        if (!symbol.empty() && isdigit(symbol[0])) {
+          std::from_chars(symbol.data(), symbol.data() + symbol.size(), n);
+        } else {
+          chunk.references.push_back({chunk.words.size(), symbol});
+        }
+        chunk.words.push_back(static_cast<uint16_t>(n) & 0x7fff);
+        break;
+      }
+
+      case InstructionType::kCInstruction:
+        chunk.words.push_back(EncodeCInstruction(instruction.destination,
+                                                 instruction.comparison,
+                                                 instruction.jump));
+        break;
+    }
+  }
+}
+
+}  // namespace
+
+std::vector<uint16_t> AssembleParallel(std::string_view source,
+                                       int num_threads,
+                                       size_t min_chunk_size,
+                                       SymbolTable* symbols,
+                                       AssemblyStats* stats) {
+  AssemblyStats local_stats;
+  if (stats == nullptr) {
+    stats = &local_stats;
+  }
+  Stopwatch stopwatch;
+  size_t num_chunks = std::max<size_t>(
+      1, std::min<size_t>(std::max(num_threads, 1) * 4,
+                          source.size() / std::max<size_t>(min_chunk_size, 1)));
+  std::vector<Chunk> chunks = SplitAtLines(source, num_chunks);
+
+  RunInParallel(chunks.size(), num_threads, [&](size_t i) {
+    ParseAndEncode(chunks[i]);
+  });
+  stopwatch.Lap(stats->parsing_ns);
+
+  // Merge the per-chunk label tables. Later definitions win, as they do when
+  // assembling serially.
+  auto symbol_table = SymbolTable::Create();
+  size_t num_labels = 0;
+  for (const Chunk& chunk : chunks) {
+    num_labels += chunk.labels.size();
+  }
+  symbol_table.Reserve(num_labels);
+  size_t num_words = 0;
+  for (Chunk& chunk : chunks) {
+    chunk.base_address = num_words;
+    for (const Label& label : chunk.labels) {
+      symbol_table.AddEntry(label.symbol, chunk.base_address + label.address);
+    }
+    num_words += chunk.words.size();
+  }
+  stats->labels += num_labels;
+  stopwatch.Lap(stats->label_collection_ns);
+
+  // The table is only read here, so chunks can share it.
+  RunInParallel(chunks.size(), num_threads, [&](size_t i) {
+    Chunk& chunk = chunks[i];
+    for (const Reference& reference : chunk.references) {
+      int n = symbol_table.Get(reference.symbol);
+      if (n < 0) {
+        chunk.unresolved.push_back(reference);
+      } else {
+        chunk.words[reference.word_index] = static_cast<uint16_t>(n) & 0x7fff;
+      }
+    }
+  });
+
+  // Variable addresses depend on the order of first use across the whole
+  // program, so they are allocated serially.
+  int next_variable_address = kFirstVariableAddress;
+  for (Chunk& chunk : chunks) {
+    for (const Reference& reference : chunk.unresolved) {
+      auto [n, inserted] =
+          symbol_table.FindOrInsert(reference.symbol, next_variable_address);
+      if (inserted) {
+        next_variable_address++;
+      }
+      chunk.words[reference.word_index] = static_cast<uint16_t>(n) & 0x7fff;
+    }
+  }
+  stats->variables += next_variable_address - kFirstVariableAddress;
+  stopwatch.Lap(stats->symbol_resolution_ns);
+
+  std::vector<uint16_t> words(num_words);
+  RunInParallel(chunks.size(), num_threads, [&](size_t i) {
+    std::copy(chunks[i].words.begin(), chunks[i].words.end(),
+              words.begin() + chunks[i].base_address);
+  });
+  stopwatch.Lap(stats->encoding_ns);
+  if (symbols != nullptr) {
+    *symbols = std::move(symbol_table);
+  }
+  return words;
+}
+
+void WriteHackTextParallel(const std::vector<uint16_t>& words,
+                           util_io::OutputSink& output, int num_threads) {
+  char* text = output.Append(words.size() * kHackTextLineLength);
+  size_t num_slices = std::max(num_threads, 1);
+  size_t slice_size = words.size() / num_slices + 1;
+  RunInParallel(num_slices, num_threads, [&](size_t slice) {
+    size_t end = std::min(words.size(), (slice + 1) * slice_size);
+    for (size_t i = slice * slice_size; i < end; i++) {
+      EncodeHackTextLine(words[i], text + i * kHackTextLineLength);
+    }
+  });
+}
+
+}  // namespace hack
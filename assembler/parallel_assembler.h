@@ -0,0 +1,41 @@
+#ifndef ASSEMBLER_PARALLEL_ASSEMBLER_H_
+#define ASSEMBLER_PARALLEL_ASSEMBLER_H_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "assembler/assembly_stats.h"
+#include "assembler/symbol_table.h"
+#include "util/io/output_sink.h"
+
+namespace hack {
+
+// Inputs smaller than this per thread are not worth splitting further.
+constexpr size_t kDefaultMinChunkSize = 1 << 16;
+
+// Assembles `source` using up to `num_threads` threads.
+//
+// The source is split at line boundaries into chunks which are parsed and
+// encoded concurrently; each chunk records its labels and symbolic references
+// relative to its own start. The per-chunk label tables are then merged at
+// their global instruction offsets, references are resolved concurrently, and
+// variables are allocated from address 16 in order of first use across the
+// whole program. The result is identical to assembling `source` serially.
+//
+// If `symbols` is not null the final symbol table is stored there. If `stats`
+// is not null, phase times, labels and variables are added to it; parsing and
+// encoding the chunks counts as parsing.
+std::vector<uint16_t> AssembleParallel(
+    std::string_view source, int num_threads,
+    size_t min_chunk_size = kDefaultMinChunkSize,
+    SymbolTable* symbols = nullptr, AssemblyStats* stats = nullptr);
+
+// Writes `words` to `output` in the textual .hack format, formatting slices of
+// the output concurrently on up to `num_threads` threads.
+void WriteHackTextParallel(const std::vector<uint16_t>& words,
+                           util_io::OutputSink& output, int num_threads);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_PARALLEL_ASSEMBLER_H_
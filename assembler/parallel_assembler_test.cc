@@ -0,0 +1,90 @@
+#include "assembler/parallel_assembler.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hack {
+namespace {
+
+constexpr std::string_view kProgram = R"asm(
+// Forward and backward label references, variables and predefined symbols.
+@i
+M=1
+(LOOP)
+@i
+D=M
+@100
+D=D-A
+@END
+D;JGT
+@sum
+M=D+M
+@i
+M=M+1
+@LOOP
+0;JMP
+(END)
+@END
+0;JMP
+@KBD
+@j
+)asm";
+
+const std::vector<uint16_t> kExpected = {
+  16, 0xefc8, 16, 0xfc10, 100, 0xe4d0, 14, 0xe301, 17, 0xf088,
+  16, 0xfdc8, 2, 0xea87, 14, 0xea87, 24576, 18
+};
+
+TEST(ParallelAssemblerTest, SingleThread) {
+  EXPECT_EQ(AssembleParallel(kProgram, 1), kExpected);
+}
+
+TEST(ParallelAssemblerTest, OneChunkPerLine) {
+  EXPECT_EQ(AssembleParallel(kProgram, 4, /*min_chunk_size=*/1), kExpected);
+}
+
+TEST(ParallelAssemblerTest, ManyChunksMatchOneChunk) {
+  std::string source;
+  for (int i = 0; i < 2000; i++) {
+    std::string n = std::to_string(i);
+    source += "@var" + std::to_string(i % 37) + "\nD=M\n@L" + n +
+        "\nD;JEQ\n(L" + n + ")\n@L" + std::to_string((i * 7) % 2000) +
+        "\n0;JMP\n";
+  }
+
+  std::vector<uint16_t> serial = AssembleParallel(source, 1, source.size());
+  std::vector<uint16_t> parallel = AssembleParallel(source, 8, 64);
+
+  ASSERT_EQ(serial.size(), 2000 * 6);
+  EXPECT_EQ(parallel, serial);
+  // Variables are allocated in order of first use.
+  EXPECT_EQ(serial[0], 16);
+  EXPECT_EQ(serial[6], 17);
+}
+
+TEST(ParallelAssemblerTest, EmptySource) {
+  EXPECT_TRUE(AssembleParallel("", 4, 1).empty());
+}
+
+TEST(ParallelAssemblerTest, WriteHackTextParallel) {
+  std::vector<uint16_t> words(1000);
+  for (size_t i = 0; i < words.size(); i++) {
+    words[i] = i * 65;
+  }
+  std::ostringstream output;
+  util_io::OutputSink sink(output);
+
+  WriteHackTextParallel(words, sink, 3);
+
+  sink.Flush();
+  std::string text = output.str();
+  ASSERT_EQ(text.size(), 17 * words.size());
+  EXPECT_EQ(text.substr(0, 17), "0000000000000000\n");
+  EXPECT_EQ(text.substr(17 * 999, 17), "1111110110100111\n");
+}
+
+}  // namespace
+}  // namespace hack
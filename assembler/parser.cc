@@ -1,6 +1,10 @@
 #include "assembler/parser.h"
 
 #include <ctype.h>
+#include <string.h>
+
+#include <iterator>
+#include <string>
 
 #include "util/parsing/whitespace.h"
 
@@ -8,8 +12,6 @@ namespace hack {
 
 using ::util_parsing::SkipWhitespaceAndComments;
 
-constexpr int kMaxLineLength = 256;
-
 namespace {
 
 // The state of the parser loop when handling a C-instruction.
@@ -26,103 +28,149 @@ enum class CParserState {
 
 }  // namespace
 
+std::string FormatInstruction(const Instruction& instruction) {
+  std::string text;
+  switch (instruction.instruction_type) {
+    case InstructionType::kAInstruction:
+      text = "@";
+      text += instruction.symbol;
+      break;
+
+    case InstructionType::kLInstruction:
+      text = "(";
+      text += instruction.symbol;
+      text += ")";
+      break;
+
+    case InstructionType::kCInstruction:
+      if (!instruction.destination.empty()) {
+        text += instruction.destination;
+        text += "=";
+      }
+      text += instruction.comparison;
+      if (!instruction.jump.empty()) {
+        text += ";";
+        text += instruction.jump;
+      }
+      break;
+  }
+  return text;
+}
+
+Parser::Parser(std::istream& input_stream) :
+    owned_source_(std::istreambuf_iterator<char>(input_stream),
+                  std::istreambuf_iterator<char>()),
+    cursor_(owned_source_.data()),
+    end_(owned_source_.data() + owned_source_.size()) {}
+
+Parser::Parser(std::string_view source) :
+    cursor_(source.data()), end_(source.data() + source.size()) {}
+
 void Parser::Advance() {
-  SkipWhitespaceAndComments(input_stream_);
+  cursor_ = SkipWhitespaceAndComments(cursor_, end_);
+  if (cursor_ == end_) {
+    return;
+  }
 
-  char ch = input_stream_.get();
+  // Clear the fields that the new instruction does not set.
+  current_instruction_ = Instruction();
+  char ch = *cursor_;
   if (ch == '@') {
+    cursor_++;
     current_instruction_.instruction_type = InstructionType::kAInstruction;
     current_instruction_.symbol = ConsumeSymbolOrConstant();
     ConsumeRestOfLine();
     return;
   } else if (ch == '(') {
+    cursor_++;
     current_instruction_.instruction_type = InstructionType::kLInstruction;
     current_instruction_.symbol = ConsumeSymbol();
-    char ch = input_stream_.get();
-    if (ch != ')') {
+    if (cursor_ == end_ || *cursor_ != ')') {
       // better error handling needed
       exit(1);
     }
+    cursor_++;
     ConsumeRestOfLine();
     return;
   }
-  input_stream_.unget();
 
   current_instruction_.instruction_type = InstructionType::kCInstruction;
-  // C-instruction: more complicated parsing. First get whole line.
-  char line[kMaxLineLength];
-  input_stream_.getline(line, kMaxLineLength);
-
-  current_instruction_.destination = "";
-  current_instruction_.jump = "";
+  // C-instruction: more complicated parsing. First find the whole line.
+  const char* line = cursor_;
+  const char* line_end = static_cast<const char*>(
+      memchr(cursor_, '\n', end_ - cursor_));
+  if (line_end == nullptr) {
+    line_end = end_;
+    cursor_ = end_;
+  } else {
+    cursor_ = line_end + 1;
+  }
 
   CParserState state = CParserState::kDest;
-  int start = 0;
-  int i = 0;
-  while (line[i] != '\0') {
-    if (state == CParserState::kDest && line[i] == '=') {
-      current_instruction_.destination = Trim(line, line + i);
-      start = i + 1;
+  const char* start = line;
+  const char* p = line;
+  while (p < line_end) {
+    if (p[0] == '/' && p + 1 < line_end && p[1] == '/') {
+      // Trailing comment.
+      break;
+    }
+
+    if (state == CParserState::kDest && *p == '=') {
+      current_instruction_.destination = Trim(line, p);
+      start = p + 1;
     }
 
-    if (line[i] == ';') {
+    if (*p == ';') {
       // For error handling this would throw if already in kJump.
-      current_instruction_.comparison = Trim(line + start, line + i);
-      start = i + 1;
+      current_instruction_.comparison = Trim(start, p);
+      start = p + 1;
       state = CParserState::kJump;
     }
-    i++;
+    p++;
   }
 
   if (state == CParserState::kJump) {
-    current_instruction_.jump = Trim(line + start, line + i);
+    current_instruction_.jump = Trim(start, p);
   } else {
-    current_instruction_.comparison = Trim(line + start, line + i);
+    current_instruction_.comparison = Trim(start, p);
   }
 }
 
 bool Parser::HasMoreLines() {
-  SkipWhitespaceAndComments(input_stream_);
-  return input_stream_.peek() != EOF;
+  cursor_ = SkipWhitespaceAndComments(cursor_, end_);
+  return cursor_ != end_;
 }
 
-std::string Parser::ConsumeSymbolOrConstant() {
-  if (isdigit(input_stream_.peek())) {
+std::string_view Parser::ConsumeSymbolOrConstant() {
+  if (cursor_ != end_ && isdigit(*cursor_)) {
     return ConsumeConstant();
   } else {
     return ConsumeSymbol();
   }
 }
 
-std::string Parser::ConsumeSymbol() {
-  std::string str;
-  char ch = input_stream_.get();
-  while (IsSymbolChar(ch)) {
-    str += ch;
-    ch = input_stream_.get();
+std::string_view Parser::ConsumeSymbol() {
+  const char* start = cursor_;
+  while (cursor_ != end_ && IsSymbolChar(*cursor_)) {
+    cursor_++;
   }
-  input_stream_.unget();
-  return str;
+  return std::string_view(start, cursor_ - start);
 }
 
-std::string Parser::ConsumeConstant() {
-  std::string str;
-  char ch = input_stream_.get();
-  while (isdigit(ch)) {
-    str += ch;
-    ch = input_stream_.get();
+std::string_view Parser::ConsumeConstant() {
+  const char* start = cursor_;
+  while (cursor_ != end_ && isdigit(*cursor_)) {
+    cursor_++;
   }
-  input_stream_.unget();
-  return str;
+  return std::string_view(start, cursor_ - start);
 }
 
 void Parser::ConsumeRestOfLine() {
   // If we were doing error handling we might also want to assert we only see
   // whitespace until the end of the line.
-  char ch = input_stream_.get();
-  while (ch != '\n') {
-    ch = input_stream_.get();
-  }
+  const char* newline = static_cast<const char*>(
+      memchr(cursor_, '\n', end_ - cursor_));
+  cursor_ = newline == nullptr ? end_ : newline + 1;
 }
 
 bool Parser::IsSymbolChar(char ch) {
@@ -130,14 +178,24 @@ bool Parser::IsSymbolChar(char ch) {
     ch == '$' || ch == ':';
 }
 
-std::string Parser::Trim(char* start, char* end) {
-  while (isspace(*start) && start < end) {
+std::string_view Parser::Trim(const char* start, const char* end) {
+  while (start < end && isspace(*start)) {
     start++;
   }
-  while (isspace(*(end - 1)) && end > start) {
+  while (end > start && isspace(*(end - 1))) {
     end--;
   }
-  return std::string(start, end);
+  return std::string_view(start, end - start);
+}
+
+std::vector<Instruction> ParseAll(std::string_view source) {
+  std::vector<Instruction> instructions;
+  Parser parser(source);
+  while (parser.HasMoreLines()) {
+    parser.Advance();
+    instructions.push_back(parser.CurrentInstruction());
+  }
+  return instructions;
 }
 
 }  // namespace hack
@@ -3,6 +3,8 @@
 
 #include <istream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace hack {
 
@@ -12,31 +14,46 @@ enum class InstructionType {
   kLInstruction
 };
 
+// A parsed instruction. The string fields are views into the parser's source
+// buffer, so parsing an instruction never allocates; they remain valid for as
+// long as that buffer does.
 struct Instruction {
   InstructionType instruction_type;
 
   // If the current instruction is (xxx), returns xxx. If the current
   // instruction is @xxx, returns xxx. Should only be called for A instructions
   // and labels.
-  std::string symbol;
+  std::string_view symbol;
 
   // Returns the symbol destination part of the current C-instruction. Should
   // be called only if InstructionType is a C instruction.
-  std::string destination;
+  std::string_view destination;
 
   // Returns the symbolic comparison part of the current C-instruction. Should
   // only be called if InstructionType is a C instruction.  
-  std::string comparison;
+  std::string_view comparison;
 
   // Returns the symbolic jump part of the current C-instruction. Should only be
   // called if InstructionType is a C instruction.
-  std::string jump;
+  std::string_view jump;
 };
 
+// Formats `instruction` the way it would be written in assembly, without a
+// newline.
+std::string FormatInstruction(const Instruction& instruction);
+
 // Parses a .asm file.
 class Parser final {
  public:
-  explicit Parser(std::istream& input_stream) : input_stream_(input_stream) {}
+  // Reads the whole of `input_stream` into memory and parses it from there.
+  explicit Parser(std::istream& input_stream);
+
+  // Parses `source` in place, e.g. a memory-mapped file. `source` must outlive
+  // the parser.
+  explicit Parser(std::string_view source);
+
+  Parser(const Parser&) = delete;
+  Parser& operator=(const Parser&) = delete;
 
   // Skips over whitespace and comments as necessary. Reads the next instruction
   // from the input and makes it the current instruction.
@@ -46,29 +63,39 @@ class Parser final {
   bool HasMoreLines();
 
   // Gets the current instruction. Should only be called after Advance() has
-  // been invoked at least once.
-  Instruction CurrentInstruction() {
+  // been invoked at least once. The reference is overwritten by the next call
+  // to Advance().
+  const Instruction& CurrentInstruction() const {
     return current_instruction_;
   }
 
  private:
-  std::istream& input_stream_;
+  // Only populated when constructed from a stream.
+  std::string owned_source_;
+
+  const char* cursor_;
+
+  const char* end_;
 
   Instruction current_instruction_;
 
-  std::string ConsumeSymbolOrConstant();
+  std::string_view ConsumeSymbolOrConstant();
 
-  std::string ConsumeSymbol();
+  std::string_view ConsumeSymbol();
 
-  std::string ConsumeConstant();
+  std::string_view ConsumeConstant();
 
   void ConsumeRestOfLine();
 
   static bool IsSymbolChar(char ch);
 
-  static std::string Trim(char* start, char* end);
+  static std::string_view Trim(const char* start, const char* end);
 };
 
+// Parses every instruction, including labels, in `source`. The instructions
+// are views into `source`.
+std::vector<Instruction> ParseAll(std::string_view source);
+
 }  // namespace hack
 
 #endif  // ASSEMBLER_PARSER_H_
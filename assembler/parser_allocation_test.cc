@@ -0,0 +1,76 @@
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "assembler/assemble.h"
+
+// Counts every heap allocation made by the test binary.
+static size_t allocation_count = 0;
+
+void* operator new(size_t size) {
+  allocation_count++;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+namespace hack {
+namespace {
+
+constexpr std::string_view kProgram = R"asm(
+// Push constant 7 onto the stack
+@7
+D=A
+@SP
+A=M
+M=D
+@SP
+M=M+1
+
+// Add the top two elements of the stack.
+@SP
+M=M-1
+A=M
+D=M
+A=A-1
+M=D+M
+
+(a.rather.long.function.name$label_that_does_not_fit_in_sso)
+@a.rather.long.function.name$label_that_does_not_fit_in_sso
+0; JMP
+)asm";
+
+// Returns the number of allocations made assembling `copies` copies of
+// kProgram.
+size_t CountAllocations(int copies) {
+  std::string source;
+  for (int i = 0; i < copies; i++) {
+    source += kProgram;
+  }
+  size_t allocations_before = allocation_count;
+  AssemblyResult result = Assemble(source);
+  size_t allocations = allocation_count - allocations_before;
+  EXPECT_EQ(result.words.size(), copies * 15);
+  return allocations;
+}
+
+TEST(ParserAllocationTest, AssemblingDoesNotAllocatePerLine) {
+  size_t allocations = CountAllocations(100);
+
+  EXPECT_EQ(CountAllocations(200), allocations);
+}
+
+}  // namespace
+}  // namespace hack
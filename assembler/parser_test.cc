@@ -1,6 +1,9 @@
 #include "assembler/parser.h"
 
 #include <sstream>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 namespace hack {
@@ -129,5 +132,48 @@ TEST(ParserTest, AdvanceSkipsComments) {
   EXPECT_EQ(instruction.symbol, "LOOP");
 }
 
+TEST(ParserTest, ParsesStringViewInPlace) {
+  std::string_view input = R"asm(
+@LOOP
+(LOOP)
+M=M-1;JGT // trailing comment
+)asm";
+  Parser p(input);
+
+  p.Advance();
+  EXPECT_EQ(p.CurrentInstruction().symbol, "LOOP");
+  p.Advance();
+  EXPECT_EQ(p.CurrentInstruction().instruction_type,
+            InstructionType::kLInstruction);
+  p.Advance();
+  Instruction instruction = p.CurrentInstruction();
+  EXPECT_EQ(instruction.destination, "M");
+  EXPECT_EQ(instruction.comparison, "M-1");
+  EXPECT_EQ(instruction.jump, "JGT");
+  EXPECT_FALSE(p.HasMoreLines());
+}
+
+TEST(ParserTest, LastLineWithoutNewline) {
+  Parser p(std::string_view("@5"));
+
+  p.Advance();
+
+  EXPECT_EQ(p.CurrentInstruction().symbol, "5");
+  EXPECT_FALSE(p.HasMoreLines());
+}
+
+TEST(ParserTest, FormatInstructionRoundTrips) {
+  std::vector<Instruction> program =
+      ParseAll("@12\n(LOOP)\n@LOOP\nD=M\n0;JMP\nAM=M-1;JNE\n");
+
+  std::vector<std::string> lines;
+  for (const Instruction& instruction : program) {
+    lines.push_back(FormatInstruction(instruction));
+  }
+
+  EXPECT_EQ(lines, (std::vector<std::string>{"@12", "(LOOP)", "@LOOP", "D=M",
+                                             "0;JMP", "AM=M-1;JNE"}));
+}
+
 }  // namespace
 }  // namespace hack
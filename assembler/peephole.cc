@@ -0,0 +1,204 @@
+#include "assembler/peephole.h"
+
+namespace hack {
+
+namespace {
+
+bool IsA(const Instruction& instruction) {
+  return instruction.instruction_type == InstructionType::kAInstruction;
+}
+
+bool IsC(const Instruction& instruction) {
+  return instruction.instruction_type == InstructionType::kCInstruction;
+}
+
+bool Writes(const Instruction& instruction, char reg) {
+  return instruction.destination.find(reg) != std::string_view::npos;
+}
+
+bool Reads(const Instruction& instruction, char reg) {
+  return instruction.comparison.find(reg) != std::string_view::npos;
+}
+
+bool Jumps(const Instruction& instruction) {
+  return !instruction.jump.empty();
+}
+
+// A C-instruction with no jump and `dest`=`comp`.
+bool IsAssignment(const Instruction& instruction, std::string_view dest,
+                  std::string_view comp) {
+  return IsC(instruction) && !Jumps(instruction) &&
+      instruction.destination == dest && instruction.comparison == comp;
+}
+
+Instruction Assignment(std::string_view dest, std::string_view comp) {
+  return {InstructionType::kCInstruction, "", dest, comp, ""};
+}
+
+// A rule looks at a run of instructions [begin, end) that contains no labels.
+// If it matches a prefix of the run it returns the length of that prefix and
+// stores what should replace it in `replacement`. Otherwise it returns 0.
+using MatchFn = size_t (*)(const Instruction* begin, const Instruction* end,
+                           std::vector<Instruction>& replacement);
+
+struct PeepholeRule {
+  std::string_view name;
+
+  MatchFn match;
+};
+
+// @X, @Y => @Y
+size_t MatchOverwrittenALoad(const Instruction* begin, const Instruction* end,
+                             std::vector<Instruction>& replacement) {
+  if (end - begin < 2 || !IsA(begin[0]) || !IsA(begin[1])) {
+    return 0;
+  }
+  replacement.push_back(begin[1]);
+  return 2;
+}
+
+// @X, <C not writing A>, @X => @X, <C>
+size_t MatchRepeatedALoad(const Instruction* begin, const Instruction* end,
+                          std::vector<Instruction>& replacement) {
+  if (end - begin < 3 || !IsA(begin[0]) || !IsC(begin[1]) ||
+      Writes(begin[1], 'A') || Jumps(begin[1]) || !IsA(begin[2]) ||
+      begin[0].symbol != begin[2].symbol) {
+    return 0;
+  }
+  replacement.push_back(begin[0]);
+  replacement.push_back(begin[1]);
+  return 3;
+}
+
+// M=M+1, AM=M-1 => A=M
+//
+// This is a stack push followed directly by a pop once the second @SP has
+// been removed.
+size_t MatchIncrementThenPop(const Instruction* begin, const Instruction* end,
+                             std::vector<Instruction>& replacement) {
+  if (end - begin < 2 || !IsAssignment(begin[0], "M", "M+1") ||
+      !(IsAssignment(begin[1], "AM", "M-1") ||
+        IsAssignment(begin[1], "MA", "M-1"))) {
+    return 0;
+  }
+  replacement.push_back(Assignment("A", "M"));
+  return 2;
+}
+
+// M=M+1, M=M-1 => (nothing), and the same the other way round.
+size_t MatchCancellingIncrement(const Instruction* begin,
+                                const Instruction* end,
+                                std::vector<Instruction>& /*replacement*/) {
+  if (end - begin < 2) {
+    return 0;
+  }
+  if ((IsAssignment(begin[0], "M", "M+1") &&
+       IsAssignment(begin[1], "M", "M-1")) ||
+      (IsAssignment(begin[0], "M", "M-1") &&
+       IsAssignment(begin[1], "M", "M+1"))) {
+    return 2;
+  }
+  return 0;
+}
+
+// D=<x>, @..., D=<y not reading D> => @..., D=<y>
+//
+// Any number of A-instructions may come in between since they do not read D.
+size_t MatchDeadDStore(const Instruction* begin, const Instruction* end,
+                       std::vector<Instruction>& replacement) {
+  if (!IsC(begin[0]) || begin[0].destination != "D" || Jumps(begin[0])) {
+    return 0;
+  }
+  const Instruction* next = begin + 1;
+  while (next != end && IsA(*next)) {
+    next++;
+  }
+  if (next == end || !Writes(*next, 'D') || Reads(*next, 'D')) {
+    return 0;
+  }
+  replacement.insert(replacement.end(), begin + 1, next + 1);
+  return next + 1 - begin;
+}
+
+// A=<x>, @Y => @Y
+size_t MatchDeadAStore(const Instruction* begin, const Instruction* end,
+                       std::vector<Instruction>& replacement) {
+  if (end - begin < 2 || !IsC(begin[0]) || begin[0].destination != "A" ||
+      Jumps(begin[0]) || !IsA(begin[1])) {
+    return 0;
+  }
+  replacement.push_back(begin[1]);
+  return 2;
+}
+
+constexpr PeepholeRule kRules[] = {
+  {"overwritten-a-load", MatchOverwrittenALoad},
+  {"repeated-a-load", MatchRepeatedALoad},
+  {"increment-then-pop", MatchIncrementThenPop},
+  {"cancelling-increment", MatchCancellingIncrement},
+  {"dead-d-store", MatchDeadDStore},
+  {"dead-a-store", MatchDeadAStore},
+};
+
+// Runs every rule once over `program`. Returns true if anything changed.
+bool RunRules(std::vector<Instruction>& program, int rule_counts[]) {
+  std::vector<Instruction> output;
+  output.reserve(program.size());
+  std::vector<Instruction> replacement;
+  bool changed = false;
+
+  const Instruction* run_end = program.data();
+  const Instruction* end = program.data() + program.size();
+  for (const Instruction* p = program.data(); p != end;) {
+    if (p->instruction_type == InstructionType::kLInstruction) {
+      output.push_back(*p++);
+      continue;
+    }
+    if (run_end <= p) {
+      run_end = p;
+      while (run_end != end &&
+             run_end->instruction_type != InstructionType::kLInstruction) {
+        run_end++;
+      }
+    }
+
+    size_t matched = 0;
+    for (size_t i = 0; i < std::size(kRules) && matched == 0; i++) {
+      replacement.clear();
+      matched = kRules[i].match(p, run_end, replacement);
+      if (matched > 0) {
+        rule_counts[i]++;
+      }
+    }
+    if (matched == 0) {
+      output.push_back(*p++);
+      continue;
+    }
+    output.insert(output.end(), replacement.begin(), replacement.end());
+    p += matched;
+    changed = true;
+  }
+
+  program.swap(output);
+  return changed;
+}
+
+}  // namespace
+
+PeepholeStats OptimizePeephole(std::vector<Instruction>& program) {
+  size_t original_size = program.size();
+  int rule_counts[std::size(kRules)] = {};
+  while (RunRules(program, rule_counts)) {
+  }
+
+  PeepholeStats stats;
+  stats.instructions_removed = original_size - program.size();
+  for (size_t i = 0; i < std::size(kRules); i++) {
+    if (rule_counts[i] > 0) {
+      stats.rule_counts.push_back({kRules[i].name, rule_counts[i]});
+    }
+  }
+  return stats;
+}
+
+}  // namespace hack
@@ -0,0 +1,33 @@
+#ifndef ASSEMBLER_PEEPHOLE_H_
+#define ASSEMBLER_PEEPHOLE_H_
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "assembler/parser.h"
+
+namespace hack {
+
+struct PeepholeStats {
+  // Instructions removed in total. Labels are not counted.
+  int instructions_removed = 0;
+
+  // How many times each rule fired, by rule name, for rules that fired.
+  std::vector<std::pair<std::string_view, int>> rule_counts;
+};
+
+// Rewrites redundant sequences in `program`, e.g. an A-instruction that is
+// immediately overwritten, a stack pointer increment that is immediately
+// undone, or a store to D that is overwritten before it is read. Rules are
+// applied until none matches.
+//
+// Rewrites never span a label, so every label still starts an equivalent
+// sequence. This assumes, as for code from the translator, that control only
+// reaches the middle of a sequence by falling through: jumps target labels, not
+// numeric ROM addresses.
+PeepholeStats OptimizePeephole(std::vector<Instruction>& program);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_PEEPHOLE_H_
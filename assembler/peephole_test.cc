@@ -0,0 +1,92 @@
+#include "assembler/peephole.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hack {
+namespace {
+
+// Formats `program` back into assembly, one instruction per line.
+std::string ToAssembly(const std::vector<Instruction>& program) {
+  std::string assembly;
+  for (const Instruction& instruction : program) {
+    assembly += FormatInstruction(instruction) + "\n";
+  }
+  return assembly;
+}
+
+std::string Optimize(std::string_view source, PeepholeStats* stats = nullptr) {
+  std::vector<Instruction> program = ParseAll(source);
+  PeepholeStats result = OptimizePeephole(program);
+  if (stats != nullptr) {
+    *stats = result;
+  }
+  return ToAssembly(program);
+}
+
+TEST(PeepholeTest, OverwrittenALoad) {
+  EXPECT_EQ(Optimize("@1\n@2\nD=A\n"), "@2\nD=A\n");
+}
+
+TEST(PeepholeTest, RepeatedALoad) {
+  EXPECT_EQ(Optimize("@SP\nM=M+1\n@SP\nA=M\n"), "@SP\nM=M+1\nA=M\n");
+}
+
+TEST(PeepholeTest, RepeatedALoadKeptAfterAWrite) {
+  EXPECT_EQ(Optimize("@SP\nAM=M+1\n@SP\nM=D\n"), "@SP\nAM=M+1\n@SP\nM=D\n");
+}
+
+TEST(PeepholeTest, PushThenPop) {
+  // The tail of a translator push followed by the head of an if-goto.
+  PeepholeStats stats;
+
+  std::string optimized =
+      Optimize("@SP\nM=M+1\n@SP\nAM=M-1\nD=M\n", &stats);
+
+  EXPECT_EQ(optimized, "@SP\nA=M\nD=M\n");
+  EXPECT_EQ(stats.instructions_removed, 2);
+}
+
+TEST(PeepholeTest, CancellingIncrement) {
+  EXPECT_EQ(Optimize("@R13\nM=M-1\nM=M+1\nD=M\n"), "@R13\nD=M\n");
+}
+
+TEST(PeepholeTest, DeadDStore) {
+  EXPECT_EQ(Optimize("D=A\n@SP\n@5\nD=M\n"), "@5\nD=M\n");
+}
+
+TEST(PeepholeTest, DStoreReadLaterIsKept) {
+  EXPECT_EQ(Optimize("D=A\n@SP\nD=D+M\n"), "D=A\n@SP\nD=D+M\n");
+}
+
+TEST(PeepholeTest, DeadAStore) {
+  EXPECT_EQ(Optimize("A=M\n@7\nD=A\n"), "@7\nD=A\n");
+}
+
+TEST(PeepholeTest, RewritesDoNotSpanLabels) {
+  std::string source = "@1\n(L)\n@2\nD=A\n@L\nD;JGT\n";
+
+  EXPECT_EQ(Optimize(source), source);
+}
+
+TEST(PeepholeTest, JumpsAreKept) {
+  std::string source = "@L\n0;JMP\n@L\nD;JEQ\n(L)\n";
+
+  EXPECT_EQ(Optimize(source), source);
+}
+
+TEST(PeepholeTest, ReportsRuleCounts) {
+  PeepholeStats stats;
+
+  Optimize("@1\n@2\n@3\nD=A\n", &stats);
+
+  EXPECT_EQ(stats.instructions_removed, 2);
+  ASSERT_EQ(stats.rule_counts.size(), 1);
+  EXPECT_EQ(stats.rule_counts[0].first, "overwritten-a-load");
+  EXPECT_EQ(stats.rule_counts[0].second, 2);
+}
+
+}  // namespace
+}  // namespace hack
@@ -0,0 +1,318 @@
+#include "assembler/pipelined_assembler.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "assembler/assemble.h"
+#include "assembler/assembly_stats.h"
+#include "assembler/code.h"
+#include "assembler/parser.h"
+#include "assembler/rom_image.h"
+#include "assembler/symbol_table.h"
+#include "util/concurrency/spsc_ring.h"
+
+namespace hack {
+
+namespace {
+
+using ::util_concurrency::SpscRing;
+
+constexpr size_t kNone = static_cast<size_t>(-1);
+
+// The final value of a word that was a placeholder when it was encoded.
+struct Patch {
+  size_t word_index;
+
+  uint16_t word;
+};
+
+struct WordBatch {
+  std::vector<uint16_t> words;
+
+  // Index in the whole program of the first placeholder in `words`, or kNone.
+  size_t first_placeholder = kNone;
+
+  // Set only in the last batch, once every symbol is known.
+  std::vector<Patch> patches;
+};
+
+// Appends whatever one read(2) of up to `max_size` bytes returns to `buffer`.
+// Sets `eof` at the end of input. Returns false if the read fails.
+bool ReadSome(int fd, size_t max_size, std::string& buffer, bool& eof) {
+  size_t old_size = buffer.size();
+  buffer.resize(old_size + max_size);
+  ssize_t n;
+  do {
+    n = read(fd, buffer.data() + old_size, max_size);
+  } while (n < 0 && errno == EINTR);
+  buffer.resize(old_size + std::max<ssize_t>(n, 0));
+  eof = n == 0;
+  return n >= 0;
+}
+
+// Splits `text`, which ends at a line boundary, into batches of about
+// `batch_size` bytes each ending at a newline, and pushes them onto `ring`.
+void PushBatches(std::string_view text, size_t batch_size,
+                 SpscRing<std::string>& ring) {
+  batch_size = std::max<size_t>(batch_size, 1);
+  while (!text.empty()) {
+    size_t end = text.size();
+    if (end > batch_size) {
+      size_t newline = text.find('\n', batch_size - 1);
+      end = newline == std::string_view::npos ? text.size() : newline + 1;
+    }
+    ring.Push(std::string(text.substr(0, end)));
+    text.remove_prefix(end);
+  }
+}
+
+// Encodes batches in order as the single-pass assembler would, recording
+// every symbolic reference.
+class Encoder final {
+ public:
+  Encoder() : symbol_table_(SymbolTable::Create()) {}
+
+  WordBatch Encode(std::string source) {
+    // Fixups point into the source, so keep it where it will not move.
+    // Short strings are stored inline and would move with the string.
+    sources_.push_back(std::move(source));
+    WordBatch batch;
+    size_t first_fixup = fixups_.size();
+    {
+      Parser parser(sources_.back());
+      while (parser.HasMoreLines()) {
+        parser.Advance();
+        const Instruction& instruction = parser.CurrentInstruction();
+        switch (instruction.instruction_type) {
+          case InstructionType::kLInstruction:
+            symbol_table_.AddEntry(instruction.symbol,
+                                   num_words_ + batch.words.size());
+            stats_.labels++;
+            break;
+
+          case InstructionType::kAInstruction: {
+            // A later label may still define or redefine any symbol, so
+            // only constants are final here.
+            std::string_view symbol = instruction.symbol;
+            int n = 0;
+            if (!symbol.empty() && isdigit(symbol[0])) {
+              std::from_chars(symbol.data(), symbol.data() + symbol.size(), n);
+            } else {
+              fixups_.push_back({num_words_ + batch.words.size(), symbol});
+            }
+            batch.words.push_back(static_cast<uint16_t>(n) & 0x7fff);
+            stats_.a_instructions++;
+            break;
+          }
+
+          case InstructionType::kCInstruction:
+            batch.words.push_back(EncodeCInstruction(instruction.destination,
+                                                     instruction.comparison,
+                                                     instruction.jump));
+            stats_.c_instructions++;
+            break;
+        }
+      }
+    }
+    if (fixups_.size() > first_fixup) {
+      batch.first_placeholder = fixups_[first_fixup].word_index;
+    } else {
+      sources_.pop_back();
+    }
+    num_words_ += batch.words.size();
+    return batch;
+  }
+
+  // Resolves every recorded reference, allocating variables in order of first
+  // use.
+  std::vector<Patch> Finish() {
+    std::vector<Patch> patches;
+    patches.reserve(fixups_.size());
+    int next_variable_address = kFirstVariableAddress;
+    for (const Fixup& fixup : fixups_) {
+      auto [n, inserted] =
+          symbol_table_.FindOrInsert(fixup.symbol, next_variable_address);
+      if (inserted) {
+        next_variable_address++;
+      }
+      patches.push_back({fixup.word_index, static_cast<uint16_t>(n & 0x7fff)});
+    }
+    stats_.variables = next_variable_address - kFirstVariableAddress;
+    stats_.symbols = symbol_table_.size();
+    return patches;
+  }
+
+  // Counts of everything encoded. Complete once Finish has returned.
+  const AssemblyStats& stats() const { return stats_; }
+
+ private:
+  struct Fixup {
+    size_t word_index;
+
+    std::string_view symbol;
+  };
+
+  SymbolTable symbol_table_;
+
+  size_t num_words_ = 0;
+
+  AssemblyStats stats_;
+
+  std::vector<Fixup> fixups_;
+
+  // Sources of batches with fixups. A deque so that adding one does not move
+  // the others.
+  std::deque<std::string> sources_;
+};
+
+// Formats batches as .hack text. Lines are written straight to the output
+// until the first placeholder and held back from there on.
+class Writer final {
+ public:
+  explicit Writer(util_io::OutputSink& output) : output_(output) {}
+
+  void Write(const WordBatch& batch) {
+    if (held_from_ == kNone) {
+      held_from_ = batch.first_placeholder;
+    }
+    size_t num_direct = held_from_ == kNone
+        ? batch.words.size()
+        : std::min(batch.words.size(),
+                   std::max(held_from_, num_words_) - num_words_);
+    char* text = output_.Append(num_direct * kHackTextLineLength);
+    for (size_t i = 0; i < num_direct; i++) {
+      EncodeHackTextLine(batch.words[i], text + i * kHackTextLineLength);
+    }
+
+    size_t old_size = held_.size();
+    held_.resize(old_size +
+                 (batch.words.size() - num_direct) * kHackTextLineLength);
+    text = held_.data() + old_size;
+    for (size_t i = num_direct; i < batch.words.size(); i++) {
+      EncodeHackTextLine(batch.words[i], text);
+      text += kHackTextLineLength;
+    }
+    num_words_ += batch.words.size();
+
+    for (const Patch& patch : batch.patches) {
+      EncodeHackTextLine(
+          patch.word,
+          held_.data() + (patch.word_index - held_from_) * kHackTextLineLength);
+    }
+  }
+
+  // Writes out the held text. Call after the last batch.
+  void Finish() {
+    output_.Write(held_);
+  }
+
+ private:
+  util_io::OutputSink& output_;
+
+  // Words written so far.
+  size_t num_words_ = 0;
+
+  // Index of the first held word, or kNone.
+  size_t held_from_ = kNone;
+
+  std::string held_;
+};
+
+// Copies the counts, but not the times, from `from`.
+void CopyCounts(const AssemblyStats& from, AssemblyStats& to) {
+  to.a_instructions = from.a_instructions;
+  to.c_instructions = from.c_instructions;
+  to.labels = from.labels;
+  to.symbols = from.symbols;
+  to.variables = from.variables;
+  to.bytes_read = from.bytes_read;
+}
+
+}  // namespace
+
+bool AssemblePipelined(int fd, util_io::OutputSink& output,
+                       const PipelineOptions& options, AssemblyStats* stats) {
+  std::string pending;
+  bool eof = false;
+  while (!eof && pending.size() < options.min_pipelined_size) {
+    if (!ReadSome(fd, options.min_pipelined_size - pending.size(), pending,
+                  eof)) {
+      return false;
+    }
+  }
+  if (eof) {
+    AssemblyOptions single_pass;
+    single_pass.single_pass = true;
+    AssemblyResult result = Assemble(pending, single_pass);
+    WriteHackText(result.words, output);
+    if (stats != nullptr) {
+      CopyCounts(result.stats, *stats);
+    }
+    return true;
+  }
+
+  SpscRing<std::string> sources(options.ring_capacity);
+  SpscRing<WordBatch> batches(options.ring_capacity);
+  Encoder encoder;
+  std::thread encoder_thread([&]() {
+    std::string source;
+    while (sources.Pop(source)) {
+      batches.Push(encoder.Encode(std::move(source)));
+    }
+    WordBatch last;
+    last.patches = encoder.Finish();
+    batches.Push(std::move(last));
+    batches.Close();
+  });
+  std::thread writer_thread([&]() {
+    Writer writer(output);
+    WordBatch batch;
+    while (batches.Pop(batch)) {
+      writer.Write(batch);
+    }
+    writer.Finish();
+  });
+
+  // This thread reads, handing on every complete line.
+  bool ok = true;
+  size_t bytes_read = 0;
+  while (true) {
+    size_t end = pending.size();
+    if (!eof) {
+      size_t newline = pending.rfind('\n');
+      end = newline == std::string::npos ? 0 : newline + 1;
+    }
+    PushBatches(std::string_view(pending).substr(0, end), options.batch_size,
+                sources);
+    bytes_read += end;
+    pending.erase(0, end);
+    if (eof) {
+      break;
+    }
+    if (!ReadSome(fd, options.batch_size, pending, eof)) {
+      ok = false;
+      break;
+    }
+  }
+  sources.Close();
+  encoder_thread.join();
+  writer_thread.join();
+  if (stats != nullptr) {
+    CopyCounts(encoder.stats(), *stats);
+    stats->bytes_read = bytes_read;
+  }
+  return ok;
+}
+
+}  // namespace hack
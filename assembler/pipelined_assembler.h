@@ -0,0 +1,43 @@
+#ifndef ASSEMBLER_PIPELINED_ASSEMBLER_H_
+#define ASSEMBLER_PIPELINED_ASSEMBLER_H_
+
+#include <cstddef>
+
+#include "assembler/assembly_stats.h"
+#include "util/io/output_sink.h"
+
+namespace hack {
+
+struct PipelineOptions {
+  // Source is handed from the reader to the encoder in batches of about this
+  // many bytes, cut at line boundaries.
+  size_t batch_size = 1 << 16;
+
+  // How many batches may be in flight between two stages.
+  size_t ring_capacity = 16;
+
+  // Inputs that end before this many bytes have been read are assembled
+  // sequentially, since starting threads would cost more than it hides.
+  size_t min_pipelined_size = 1 << 20;
+};
+
+// Assembles Hack assembly read from `fd` and writes it to `output` in the
+// textual .hack format, with reading, encoding and writing on three threads
+// connected by SPSC rings. The output is identical to single-pass assembly.
+//
+// Words are written as soon as they are encoded up to the first symbolic
+// reference, whose value is not known until the last definition of every
+// label has been read. From there on the formatted text is held back and
+// patched once the whole input has been read.
+//
+// If `stats` is not null, fills in its counts and bytes_read. The stages
+// overlap, so timing the run is left to the caller.
+//
+// Returns false if `fd` could not be read.
+bool AssemblePipelined(int fd, util_io::OutputSink& output,
+                       const PipelineOptions& options = {},
+                       AssemblyStats* stats = nullptr);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_PIPELINED_ASSEMBLER_H_
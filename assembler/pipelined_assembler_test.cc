@@ -0,0 +1,129 @@
+#include "assembler/pipelined_assembler.h"
+
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "assembler/assemble.h"
+#include "assembler/assembly_stats.h"
+#include "assembler/benchmark_corpus.h"
+#include "assembler/rom_image.h"
+#include "util/io/output_sink.h"
+
+namespace hack {
+namespace {
+
+std::string AssembleSequentially(const std::string& source) {
+  std::ostringstream output;
+  WriteHackText(Assemble(source).words, output);
+  return output.str();
+}
+
+// Feeds `source` through a pipe in small writes, so that reads return partial
+// lines.
+std::string AssembleThroughPipe(const std::string& source,
+                                const PipelineOptions& options,
+                                AssemblyStats* stats = nullptr) {
+  int fds[2];
+  EXPECT_EQ(pipe(fds), 0);
+  std::thread feeder([&]() {
+    for (size_t i = 0; i < source.size(); i += 1000) {
+      size_t size = std::min<size_t>(1000, source.size() - i);
+      EXPECT_EQ(write(fds[1], source.data() + i, size), size);
+    }
+    close(fds[1]);
+  });
+
+  std::ostringstream output;
+  {
+    util_io::OutputSink sink(output);
+    EXPECT_TRUE(AssemblePipelined(fds[0], sink, options, stats));
+  }
+  feeder.join();
+  close(fds[0]);
+  return output.str();
+}
+
+TEST(PipelinedAssemblerTest, AssemblesSmallInputSequentially) {
+  std::string source = "@x\nD=M\n(LOOP)\n@LOOP\n0;JMP\n";
+
+  EXPECT_EQ(AssembleThroughPipe(source, {}), AssembleSequentially(source));
+}
+
+TEST(PipelinedAssemblerTest, MatchesSequentialAssembly) {
+  std::string source = GenerateTranslatedProgram(50000);
+  PipelineOptions options;
+  options.batch_size = 300;
+  options.ring_capacity = 2;
+  options.min_pipelined_size = 0;
+
+  EXPECT_EQ(AssembleThroughPipe(source, options),
+            AssembleSequentially(source));
+}
+
+TEST(PipelinedAssemblerTest, PatchesForwardReferencesAndVariables) {
+  std::string source =
+      "@1\nD=A\n@2\nD=D+A\n"
+      "@END\n0;JMP\n@x\nM=D\n@y\nM=D\n@x\nD=M\n(END)\n@END\n0;JMP";
+  PipelineOptions options;
+  options.batch_size = 1;
+  options.min_pipelined_size = 0;
+
+  EXPECT_EQ(AssembleThroughPipe(source, options),
+            AssembleSequentially(source));
+}
+
+TEST(PipelinedAssemblerTest, LaterLabelDefinitionsWin) {
+  std::string source = "@1\nD=A\n(L)\n@L\n0;JMP\n@SP\nM=D\n"
+                       "(L)\n@L\n0;JMP\n(SP)\n@SP\n@x\n";
+  PipelineOptions options;
+  options.batch_size = 1;
+  options.min_pipelined_size = 0;
+
+  EXPECT_EQ(AssembleThroughPipe(source, options),
+            AssembleSequentially(source));
+  options.min_pipelined_size = 1 << 20;
+  EXPECT_EQ(AssembleThroughPipe(source, options),
+            AssembleSequentially(source));
+}
+
+TEST(PipelinedAssemblerTest, CountsTheSameWork) {
+  std::string source = GenerateTranslatedProgram(5000);
+  AssemblyStats expected = Assemble(source).stats;
+  PipelineOptions options;
+  options.batch_size = 300;
+
+  for (size_t min_pipelined_size : {size_t{0}, source.size() + 1}) {
+    options.min_pipelined_size = min_pipelined_size;
+    AssemblyStats stats;
+    AssembleThroughPipe(source, options, &stats);
+
+    EXPECT_EQ(stats.a_instructions, expected.a_instructions);
+    EXPECT_EQ(stats.c_instructions, expected.c_instructions);
+    EXPECT_EQ(stats.labels, expected.labels);
+    EXPECT_EQ(stats.symbols, expected.symbols);
+    EXPECT_EQ(stats.variables, expected.variables);
+    EXPECT_EQ(stats.bytes_read, source.size());
+  }
+}
+
+TEST(PipelinedAssemblerTest, HandlesEmptyInput) {
+  PipelineOptions options;
+  options.min_pipelined_size = 0;
+
+  EXPECT_EQ(AssembleThroughPipe("", options), "");
+}
+
+TEST(PipelinedAssemblerTest, FailsOnUnreadableDescriptor) {
+  std::ostringstream output;
+  util_io::OutputSink sink(output);
+
+  EXPECT_FALSE(AssemblePipelined(-1, sink));
+}
+
+}  // namespace
+}  // namespace hack
@@ -0,0 +1,107 @@
+#include "assembler/rom_image.h"
+
+#include <algorithm>
+#include <string>
+
+#include "util/io/little_endian.h"
+
+namespace hack {
+
+using ::util_io::GetUint16;
+using ::util_io::GetUint32;
+using ::util_io::PutUint16;
+using ::util_io::PutUint32;
+
+constexpr uint32_t kFnvOffsetBasis = 2166136261u;
+constexpr uint32_t kFnvPrime = 16777619u;
+
+uint32_t RomImageChecksum(const std::vector<uint16_t>& words) {
+  uint32_t hash = kFnvOffsetBasis;
+  for (uint16_t word : words) {
+    hash = (hash ^ (word & 0xff)) * kFnvPrime;
+    hash = (hash ^ (word >> 8)) * kFnvPrime;
+  }
+  return hash;
+}
+
+void WriteRomImage(const std::vector<uint16_t>& words, std::ostream& output) {
+  std::string image;
+  image.reserve(kRomImageHeaderSize + 2 * words.size());
+  image.append(kRomImageMagic);
+  PutUint16(image, kRomImageVersion);
+  PutUint16(image, 0);
+  PutUint32(image, words.size());
+  PutUint32(image, RomImageChecksum(words));
+  for (uint16_t word : words) {
+    PutUint16(image, word);
+  }
+  output.write(image.data(), image.size());
+}
+
+std::optional<std::vector<uint16_t>> ReadRomImage(std::string_view image) {
+  if (image.size() < kRomImageHeaderSize ||
+      image.substr(0, kRomImageMagic.size()) != kRomImageMagic ||
+      GetUint16(image.data() + 4) != kRomImageVersion) {
+    return {};
+  }
+  uint32_t word_count = GetUint32(image.data() + 8);
+  if (image.size() - kRomImageHeaderSize != 2 * size_t{word_count}) {
+    return {};
+  }
+
+  std::vector<uint16_t> words(word_count);
+  const char* p = image.data() + kRomImageHeaderSize;
+  for (uint32_t i = 0; i < word_count; i++, p += 2) {
+    words[i] = GetUint16(p);
+  }
+  if (RomImageChecksum(words) != GetUint32(image.data() + 12)) {
+    return {};
+  }
+  return words;
+}
+
+void WriteHackText(const std::vector<uint16_t>& words,
+                   util_io::OutputSink& output) {
+  // Format a batch of lines at a time straight into the sink's buffer.
+  constexpr size_t kWordsPerBatch = 4096;
+  for (size_t i = 0; i < words.size(); i += kWordsPerBatch) {
+    size_t batch_size = std::min(kWordsPerBatch, words.size() - i);
+    char* line = output.Append(batch_size * kHackTextLineLength);
+    for (size_t j = i; j < i + batch_size; j++) {
+      EncodeHackTextLine(words[j], line);
+      line += kHackTextLineLength;
+    }
+  }
+}
+
+void WriteHackText(const std::vector<uint16_t>& words, std::ostream& output) {
+  util_io::OutputSink sink(output);
+  WriteHackText(words, sink);
+}
+
+std::optional<std::vector<uint16_t>> ReadHackText(std::string_view text) {
+  std::vector<uint16_t> words;
+  words.reserve(text.size() / kHackTextLineLength);
+  while (!text.empty()) {
+    size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    if (line.size() != 16) {
+      return {};
+    }
+    uint16_t word = 0;
+    for (char ch : line) {
+      if (ch != '0' && ch != '1') {
+        return {};
+      }
+      word = (word << 1) | (ch == '1');
+    }
+    words.push_back(word);
+  }
+  return words;
+}
+
+}  // namespace hack
@@ -0,0 +1,63 @@
+#ifndef ASSEMBLER_ROM_IMAGE_H_
+#define ASSEMBLER_ROM_IMAGE_H_
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "util/io/output_sink.h"
+
+namespace hack {
+
+// A packed ROM image is a 16 byte header followed by the program words as
+// little-endian uint16s, so it can be loaded with a single read or mmap.
+//
+// Header layout (all fields little-endian):
+//   bytes 0-3   magic "HROM"
+//   bytes 4-5   format version
+//   bytes 6-7   reserved, zero
+//   bytes 8-11  number of words
+//   bytes 12-15 checksum of the word bytes (FNV-1a)
+constexpr std::string_view kRomImageMagic = "HROM";
+constexpr uint16_t kRomImageVersion = 1;
+constexpr size_t kRomImageHeaderSize = 16;
+
+// Returns the checksum stored in a ROM image header for `words`.
+uint32_t RomImageChecksum(const std::vector<uint16_t>& words);
+
+// Writes `words` to `output` as a packed ROM image.
+void WriteRomImage(const std::vector<uint16_t>& words, std::ostream& output);
+
+// Decodes a packed ROM image. Returns nothing if the magic, version, size or
+// checksum do not match.
+std::optional<std::vector<uint16_t>> ReadRomImage(std::string_view image);
+
+// Length of one line of .hack text, including the newline.
+constexpr size_t kHackTextLineLength = 17;
+
+// Formats `word` as one line of .hack text at `line`, which must have room
+// for kHackTextLineLength characters.
+inline void EncodeHackTextLine(uint16_t word, char* line) {
+  for (int bit = 0; bit < 16; bit++) {
+    line[bit] = (word >> (15 - bit)) & 1 ? '1' : '0';
+  }
+  line[16] = '\n';
+}
+
+// Writes `words` to `output` in the textual .hack format: one 16 character
+// binary string per line.
+void WriteHackText(const std::vector<uint16_t>& words,
+                   util_io::OutputSink& output);
+
+// As above, for callers that already have a stream.
+void WriteHackText(const std::vector<uint16_t>& words, std::ostream& output);
+
+// Decodes .hack text. Lines may end in "\r\n" and the last newline is
+// optional. Returns nothing if any line is not 16 '0' or '1' characters.
+std::optional<std::vector<uint16_t>> ReadHackText(std::string_view text);
+
+}  // namespace hack
+
+#endif  // ASSEMBLER_ROM_IMAGE_H_
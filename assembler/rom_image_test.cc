@@ -0,0 +1,107 @@
+#include "assembler/rom_image.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace hack {
+namespace {
+
+TEST(RomImageTest, RoundTrips) {
+  std::vector<uint16_t> words = {0x0010, 0xec10, 0xffff, 0x0000};
+  std::ostringstream output;
+
+  WriteRomImage(words, output);
+
+  EXPECT_EQ(output.str().size(), kRomImageHeaderSize + 2 * words.size());
+  EXPECT_EQ(ReadRomImage(output.str()), words);
+}
+
+TEST(RomImageTest, WordsAreLittleEndian) {
+  std::ostringstream output;
+
+  WriteRomImage({0xec10}, output);
+
+  std::string image = output.str();
+  EXPECT_EQ(image.substr(0, 4), "HROM");
+  EXPECT_EQ(static_cast<unsigned char>(image[16]), 0x10);
+  EXPECT_EQ(static_cast<unsigned char>(image[17]), 0xec);
+}
+
+TEST(RomImageTest, EmptyProgram) {
+  std::ostringstream output;
+
+  WriteRomImage({}, output);
+
+  EXPECT_EQ(ReadRomImage(output.str()), std::vector<uint16_t>());
+}
+
+TEST(RomImageTest, RejectsCorruptedWords) {
+  std::ostringstream output;
+  WriteRomImage({1, 2, 3}, output);
+  std::string image = output.str();
+  image[18] ^= 1;
+
+  EXPECT_FALSE(ReadRomImage(image).has_value());
+}
+
+TEST(RomImageTest, RejectsTruncatedImage) {
+  std::ostringstream output;
+  WriteRomImage({1, 2, 3}, output);
+  std::string image = output.str();
+  image.pop_back();
+
+  EXPECT_FALSE(ReadRomImage(image).has_value());
+}
+
+TEST(RomImageTest, RejectsTextFormat) {
+  EXPECT_FALSE(ReadRomImage("0000000000010000\n").has_value());
+}
+
+TEST(RomImageTest, WriteHackText) {
+  std::ostringstream output;
+
+  WriteHackText({0x0010, 0xec10}, output);
+
+  EXPECT_EQ(output.str(), "0000000000010000\n1110110000010000\n");
+}
+
+TEST(RomImageTest, WriteHackTextThroughSmallSink) {
+  std::vector<uint16_t> words(10000);
+  for (size_t i = 0; i < words.size(); i++) {
+    words[i] = i;
+  }
+  std::ostringstream output;
+  util_io::OutputSink sink(output, 100);
+
+  WriteHackText(words, sink);
+
+  ASSERT_TRUE(sink.Flush());
+  std::string text = output.str();
+  ASSERT_EQ(text.size(), words.size() * kHackTextLineLength);
+  EXPECT_EQ(sink.bytes_written(), text.size());
+  EXPECT_EQ(text.substr(9999 * kHackTextLineLength, kHackTextLineLength),
+            "0010011100001111\n");
+}
+
+TEST(RomImageTest, ReadsHackText) {
+  std::vector<uint16_t> words = {0x0010, 0xec10, 0xffff, 0x0000};
+  std::ostringstream output;
+  WriteHackText(words, output);
+
+  EXPECT_EQ(ReadHackText(output.str()), words);
+  EXPECT_EQ(ReadHackText("0000000000000010\r\n1110110000010000"),
+            std::vector<uint16_t>({0x0002, 0xec10}));
+  EXPECT_EQ(ReadHackText(""), std::vector<uint16_t>());
+}
+
+TEST(RomImageTest, RejectsMalformedHackText) {
+  EXPECT_EQ(ReadHackText("000000000000001\n"), std::nullopt);
+  EXPECT_EQ(ReadHackText("0000000000000012\n"), std::nullopt);
+  EXPECT_EQ(ReadHackText("0000000000000010\n\n"), std::nullopt);
+}
+
+}  // namespace
+}  // namespace hack
@@ -0,0 +1,39 @@
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+#include "assembler/rom_image.h"
+#include "util/io/mapped_file.h"
+
+using ::hack::ReadRomImage;
+using ::hack::WriteHackText;
+using ::util_io::MappedFile;
+
+// Converts a packed ROM image, as written by `assembler --format=binary`, back
+// into the textual .hack format on stdout.
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: rom_to_hack <file>" << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path absolute_path = std::filesystem::absolute(argv[1]);
+  std::optional<MappedFile> input_file =
+      MappedFile::Open(absolute_path.string());
+  if (!input_file) {
+    std::cerr << "Could not open '" << absolute_path << "'" << std::endl;
+    return 2;
+  }
+
+  std::optional<std::vector<uint16_t>> words =
+      ReadRomImage(input_file->contents());
+  if (!words) {
+    std::cerr << "'" << absolute_path << "' is not a valid ROM image"
+              << std::endl;
+    return 3;
+  }
+  WriteHackText(*words, std::cout);
+
+  return 0;
+}
@@ -1,57 +1,125 @@
 #include "assembler/symbol_table.h"
 
-#include <array>
 #include <string_view>
 
 namespace hack {
 
-constexpr std::pair<std::string_view, int> kSymbolInitTable[] = {
-  {"R0", 0},
-  {"R1", 1},
-  {"R2", 2},
-  {"R3", 3},
-  {"R4", 4},
-  {"R5", 5},
-  {"R6", 6},
-  {"R7", 7},
-  {"R8", 8},
-  {"R9", 9},
-  {"R10", 10},
-  {"R11", 11},
-  {"R12", 12},
-  {"R13", 13},
-  {"R14", 14},
-  {"R15", 15},
-  {"SP", 0},
-  {"LCL", 1},
-  {"ARG", 2},
-  {"THIS", 3},
-  {"THAT", 4},
-  {"SCREEN", 16384},
-  {"KBD", 2457}
-};
+// Tables are kept at most half full so that probe sequences stay short.
+constexpr size_t kMinSlotCount = 64;
+
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
 
 SymbolTable SymbolTable::Create() {
-  SymbolTable table;
-  for (auto el : kSymbolInitTable) {
+  SymbolTable table = CreateEmpty();
+  for (auto el : kPredefinedSymbols) {
     table.AddEntry(el.first, el.second);
   }
   return table;
 }
 
+SymbolTable SymbolTable::CreateEmpty() {
+  SymbolTable table;
+  table.Rehash(kMinSlotCount);
+  return table;
+}
+
+void SymbolTable::Reserve(size_t n) {
+  size_t slot_count = slots_.size();
+  while ((size_ + n) * 2 > slot_count) {
+    slot_count *= 2;
+  }
+  if (slot_count != slots_.size()) {
+    Rehash(slot_count);
+  }
+}
+
 void SymbolTable::AddEntry(std::string_view symbol, int value) {
-  symbols_[symbol] = value;
+  uint64_t hash = Hash(symbol);
+  size_t index = FindSlot(symbol, hash);
+  if (slots_[index].key_offset != kEmptySlot) {
+    slots_[index].value = value;
+    return;
+  }
+  Insert(index, symbol, hash, value);
 }
 
-bool SymbolTable::Contains(std::string_view symbol) {
-  return symbols_.find(symbol) != symbols_.end();
+bool SymbolTable::Contains(std::string_view symbol) const {
+  return slots_[FindSlot(symbol, Hash(symbol))].key_offset != kEmptySlot;
 }
 
-int SymbolTable::Get(std::string_view symbol) {
-  if (auto it = symbols_.find(symbol); it != symbols_.end()) {
-    return it->second;
+int SymbolTable::Get(std::string_view symbol) const {
+  const Slot& slot = slots_[FindSlot(symbol, Hash(symbol))];
+  if (slot.key_offset != kEmptySlot) {
+    return slot.value;
   }
   return -1;
 }
 
+std::pair<int, bool> SymbolTable::FindOrInsert(std::string_view symbol,
+                                               int value) {
+  uint64_t hash = Hash(symbol);
+  size_t index = FindSlot(symbol, hash);
+  if (slots_[index].key_offset != kEmptySlot) {
+    return {slots_[index].value, false};
+  }
+  Insert(index, symbol, hash, value);
+  return {value, true};
+}
+
+uint64_t SymbolTable::Hash(std::string_view symbol) {
+  uint64_t hash = kFnvOffsetBasis;
+  for (char ch : symbol) {
+    hash = (hash ^ static_cast<unsigned char>(ch)) * kFnvPrime;
+  }
+  return hash;
+}
+
+size_t SymbolTable::FindSlot(std::string_view symbol, uint64_t hash) const {
+  size_t mask = slots_.size() - 1;
+  uint32_t short_hash = ShortHash(hash);
+  size_t index = short_hash & mask;
+  while (true) {
+    const Slot& slot = slots_[index];
+    if (slot.key_offset == kEmptySlot ||
+        (slot.hash == short_hash && KeyAt(slot) == symbol)) {
+      return index;
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+void SymbolTable::Insert(size_t index, std::string_view symbol, uint64_t hash,
+                         int value) {
+  Slot& slot = slots_[index];
+  slot.key_offset = arena_.size();
+  slot.key_length = symbol.size();
+  slot.hash = ShortHash(hash);
+  slot.value = value;
+  arena_.append(symbol);
+  size_++;
+
+  if (size_ * 2 > slots_.size()) {
+    Rehash(slots_.size() * 2);
+  }
+}
+
+void SymbolTable::Rehash(size_t slot_count) {
+  std::vector<Slot> old_slots(slot_count, Slot{kEmptySlot, 0, 0, 0});
+  old_slots.swap(slots_);
+
+  size_t mask = slots_.size() - 1;
+  for (const Slot& slot : old_slots) {
+    if (slot.key_offset == kEmptySlot) {
+      continue;
+    }
+    // Keys are distinct, so only an empty slot needs to be found.
+    size_t index = slot.hash & mask;
+    while (slots_[index].key_offset != kEmptySlot) {
+      index = (index + 1) & mask;
+    }
+    slots_[index] = slot;
+  }
+}
+
 }  // namespace hack
@@ -1,25 +1,129 @@
 #ifndef ASSEMBLER_SYMBOL_TABLE_H_
 #define ASSEMBLER_SYMBOL_TABLE_H_
 
-#include <map>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace hack {
 
+// Variables are allocated addresses from here up, in order of first use.
+constexpr int kFirstVariableAddress = 16;
+
+// The symbols every Hack program starts with.
+inline constexpr std::pair<std::string_view, int> kPredefinedSymbols[] = {
+  {"R0", 0},
+  {"R1", 1},
+  {"R2", 2},
+  {"R3", 3},
+  {"R4", 4},
+  {"R5", 5},
+  {"R6", 6},
+  {"R7", 7},
+  {"R8", 8},
+  {"R9", 9},
+  {"R10", 10},
+  {"R11", 11},
+  {"R12", 12},
+  {"R13", 13},
+  {"R14", 14},
+  {"R15", 15},
+  {"SP", 0},
+  {"LCL", 1},
+  {"ARG", 2},
+  {"THIS", 3},
+  {"THAT", 4},
+  {"SCREEN", 16384},
+  {"KBD", 24576}
+};
+
+// Maps symbols to addresses. This is a flat open-addressing hash table: the
+// table owns a copy of every key, packed end to end in a single arena, so
+// callers may pass views into short-lived parser state.
 class SymbolTable final {
  public:
+  // Returns a table holding the predefined Hack symbols.
   static SymbolTable Create();
 
+  // Returns a table with no symbols at all.
+  static SymbolTable CreateEmpty();
+
+  // Makes room for `n` more symbols without rehashing.
+  void Reserve(size_t n);
+
+  // Adds `symbol`, or overwrites its value if it is already present.
   void AddEntry(std::string_view symbol, int value);
 
-  bool Contains(std::string_view symbol);
+  bool Contains(std::string_view symbol) const;
+
+  // Returns the value of `symbol`, or -1 if it is not present.
+  int Get(std::string_view symbol) const;
 
-  int Get(std::string_view symbol);
+  // Returns the value of `symbol` and false if it is present. Otherwise adds it
+  // with `value` and returns `value` and true. Needs only one probe sequence.
+  std::pair<int, bool> FindOrInsert(std::string_view symbol, int value);
+
+  // Calls `fn(symbol, value)` for every symbol in the table, in no particular
+  // order.
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    for (const Slot& slot : slots_) {
+      if (slot.key_offset != kEmptySlot) {
+        fn(KeyAt(slot), slot.value);
+      }
+    }
+  }
+
+  // The number of symbols in the table.
+  size_t size() const {
+    return size_;
+  }
 
  private:
+  struct Slot {
+    // Offset of the key in arena_, or kEmptySlot.
+    uint32_t key_offset;
+
+    uint32_t key_length;
+
+    // The key's ShortHash. Picks the home slot and is compared before the key
+    // bytes.
+    uint32_t hash;
+
+    int value;
+  };
+
+  static constexpr uint32_t kEmptySlot = 0xffffffff;
+
   SymbolTable() {}
 
-  std::map<std::string_view, int> symbols_;
+  static uint64_t Hash(std::string_view symbol);
+
+  // The high bits of FNV-1a are better mixed than the low ones.
+  static uint32_t ShortHash(uint64_t hash) {
+    return static_cast<uint32_t>(hash >> 32);
+  }
+
+  // Returns the index of the slot holding `symbol`, or of the empty slot where
+  // it would be inserted.
+  size_t FindSlot(std::string_view symbol, uint64_t hash) const;
+
+  // Fills the empty slot at `index` with `symbol`.
+  void Insert(size_t index, std::string_view symbol, uint64_t hash, int value);
+
+  void Rehash(size_t slot_count);
+
+  std::string_view KeyAt(const Slot& slot) const {
+    return std::string_view(arena_.data() + slot.key_offset, slot.key_length);
+  }
+
+  std::vector<Slot> slots_;
+
+  std::string arena_;
+
+  size_t size_ = 0;
 };
 
 }
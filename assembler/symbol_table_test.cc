@@ -1,5 +1,7 @@
 #include "assembler/symbol_table.h"
 
+#include <string>
+
 #include <gtest/gtest.h>
 
 namespace hack {
@@ -12,5 +14,59 @@ TEST(SymbolTableTest, CreateInitsTheTable) {
   EXPECT_EQ(table.Get("R15"), 15);
 }
 
+TEST(SymbolTableTest, AddEntryOwnsTheKey) {
+  SymbolTable table = SymbolTable::Create();
+  {
+    std::string symbol = "SOME_RATHER_LONG_LABEL_NAME";
+    table.AddEntry(symbol, 42);
+    symbol.assign(symbol.size(), 'x');
+  }
+
+  EXPECT_TRUE(table.Contains("SOME_RATHER_LONG_LABEL_NAME"));
+  EXPECT_EQ(table.Get("SOME_RATHER_LONG_LABEL_NAME"), 42);
+}
+
+TEST(SymbolTableTest, GetMissingIsNegative) {
+  SymbolTable table = SymbolTable::Create();
+
+  EXPECT_FALSE(table.Contains("LOOP"));
+  EXPECT_EQ(table.Get("LOOP"), -1);
+}
+
+TEST(SymbolTableTest, AddEntryOverwrites) {
+  SymbolTable table = SymbolTable::Create();
+  size_t size = table.size();
+
+  table.AddEntry("SP", 7);
+
+  EXPECT_EQ(table.Get("SP"), 7);
+  EXPECT_EQ(table.size(), size);
+}
+
+TEST(SymbolTableTest, FindOrInsert) {
+  SymbolTable table = SymbolTable::Create();
+
+  EXPECT_EQ(table.FindOrInsert("i", 16), std::make_pair(16, true));
+  EXPECT_EQ(table.FindOrInsert("i", 17), std::make_pair(16, false));
+  EXPECT_EQ(table.FindOrInsert("KBD", 17), std::make_pair(24576, false));
+  EXPECT_EQ(table.Get("i"), 16);
+}
+
+TEST(SymbolTableTest, GrowsPastReservedSize) {
+  SymbolTable table = SymbolTable::Create();
+  table.Reserve(100);
+  size_t predefined = table.size();
+
+  for (int i = 0; i < 100000; i++) {
+    table.AddEntry("LABEL_" + std::to_string(i), i);
+  }
+
+  EXPECT_EQ(table.size(), predefined + 100000);
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_EQ(table.Get("LABEL_" + std::to_string(i)), i);
+  }
+  EXPECT_EQ(table.Get("R15"), 15);
+}
+
 }  // namespace
 }  // namespace hack
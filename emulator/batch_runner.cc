@@ -0,0 +1,209 @@
+#include "emulator/batch_runner.h"
+
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "emulator/cpu.h"
+#include "emulator/decode.h"
+#include "util/concurrency/work_stealing.h"
+
+namespace hack {
+
+namespace {
+
+constexpr std::string_view kStopReasonNames[] = {
+  "halted", "out_of_rom", "instruction_limit", "unknown_jump_target"};
+
+// Parses all of `text` as a decimal number in [min, max].
+template <typename T>
+bool ParseNumber(std::string_view text, T min, T max, T& value) {
+  const char* end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, value);
+  return ec == std::errc() && ptr == end && !text.empty() && value >= min &&
+         value <= max;
+}
+
+// Parses the value of ram=.
+bool ParseRegion(std::string_view text, RamRegion& region) {
+  size_t colon = text.find(':');
+  if (colon == std::string_view::npos ||
+      !ParseNumber<uint16_t>(text.substr(0, colon), 0, kRamSize - 1,
+                             region.address)) {
+    return false;
+  }
+  std::string_view values = text.substr(colon + 1);
+  for (;;) {
+    size_t comma = values.find(',');
+    int value;
+    if (!ParseNumber(values.substr(0, comma), -0x8000, 0xffff, value)) {
+      return false;
+    }
+    region.values.push_back(value);
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    values.remove_prefix(comma + 1);
+  }
+  return region.address + region.values.size() <= kRamSize;
+}
+
+// Parses the value of dump=.
+bool ParseRange(std::string_view text, RamRange& range) {
+  size_t colon = text.find(':');
+  range.count = 1;
+  return ParseNumber<uint16_t>(text.substr(0, colon), 0, kRamSize - 1,
+                               range.address) &&
+         (colon == std::string_view::npos ||
+          ParseNumber<uint16_t>(text.substr(colon + 1), 1, kRamSize,
+                                range.count)) &&
+         range.address + range.count <= kRamSize;
+}
+
+// Splits `line` at runs of spaces and tabs.
+std::vector<std::string_view> SplitFields(std::string_view line) {
+  std::vector<std::string_view> fields;
+  size_t start = 0;
+  while ((start = line.find_first_not_of(" \t\r", start)) !=
+         std::string_view::npos) {
+    size_t end = line.find_first_of(" \t\r", start);
+    fields.push_back(line.substr(start, end - start));
+    start = end;
+  }
+  return fields;
+}
+
+// Parses the options after a job's name and ROM. Returns a description of
+// the first bad one, or nothing.
+std::optional<std::string> ParseJobOptions(
+    const std::vector<std::string_view>& fields, BatchJob& job) {
+  for (size_t i = 2; i < fields.size(); i++) {
+    std::string_view field = fields[i];
+    if (field.substr(0, 17) == "max_instructions=") {
+      uint64_t max_instructions;
+      if (!ParseNumber<uint64_t>(field.substr(17), 0, UINT64_MAX,
+                                 max_instructions)) {
+        return "bad instruction budget '" + std::string(field) + "'";
+      }
+      job.max_instructions = max_instructions;
+    } else if (field.substr(0, 4) == "ram=") {
+      RamRegion region;
+      if (!ParseRegion(field.substr(4), region)) {
+        return "bad RAM region '" + std::string(field) + "'";
+      }
+      job.initial_ram.push_back(std::move(region));
+    } else if (field.substr(0, 5) == "dump=") {
+      RamRange range;
+      if (!ParseRange(field.substr(5), range)) {
+        return "bad dump '" + std::string(field) + "'";
+      }
+      job.dumps.push_back(range);
+    } else {
+      return "unknown option '" + std::string(field) + "'";
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<BatchManifest> ParseManifest(std::string_view text,
+                                           std::string* error) {
+  BatchManifest manifest;
+  std::unordered_map<std::string_view, size_t> programs;
+  std::unordered_set<std::string_view> names;
+  int line_number = 0;
+  while (!text.empty()) {
+    line_number++;
+    size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    text.remove_prefix(newline == std::string_view::npos ? text.size()
+                                                         : newline + 1);
+    std::vector<std::string_view> fields = SplitFields(line);
+    if (fields.empty() || fields[0][0] == '#') {
+      continue;
+    }
+    std::string prefix = "Line " + std::to_string(line_number) + ": ";
+    if (fields.size() < 2) {
+      *error = prefix + "expected a job name and a ROM";
+      return std::nullopt;
+    }
+    if (!names.insert(fields[0]).second) {
+      *error = prefix + "job '" + std::string(fields[0]) +
+               "' is defined more than once";
+      return std::nullopt;
+    }
+
+    BatchJob job;
+    job.name = fields[0];
+    auto [program, added] =
+        programs.emplace(fields[1], manifest.rom_paths.size());
+    if (added) {
+      manifest.rom_paths.emplace_back(fields[1]);
+    }
+    job.program = program->second;
+    if (std::optional<std::string> problem = ParseJobOptions(fields, job)) {
+      *error = prefix + *problem;
+      return std::nullopt;
+    }
+    manifest.jobs.push_back(std::move(job));
+  }
+  return manifest;
+}
+
+std::vector<BatchResult> RunBatch(
+    const std::vector<std::shared_ptr<const std::vector<Op>>>& programs,
+    const std::vector<BatchJob>& jobs, const BatchOptions& options) {
+  std::vector<BatchResult> results(jobs.size());
+  util_concurrency::RunWorkStealing(
+      jobs.size(), options.num_threads, [&](size_t i) {
+        const BatchJob& job = jobs[i];
+        Cpu cpu(programs[job.program]);
+        for (const RamRegion& region : job.initial_ram) {
+          for (size_t j = 0; j < region.values.size(); j++) {
+            cpu.set_ram(region.address + j, region.values[j]);
+          }
+        }
+
+        BatchResult& result = results[i];
+        result.run =
+            cpu.Run(job.max_instructions.value_or(options.max_instructions));
+        result.pc = cpu.pc();
+        for (const RamRange& range : job.dumps) {
+          RamRegion region = {range.address, {}};
+          for (size_t j = 0; j < range.count; j++) {
+            region.values.push_back(cpu.ram(range.address + j));
+          }
+          result.ram.push_back(std::move(region));
+        }
+      });
+  return results;
+}
+
+void WriteBatchResults(const std::vector<BatchJob>& jobs,
+                       const std::vector<BatchResult>& results,
+                       std::ostream& output) {
+  for (size_t i = 0; i < jobs.size(); i++) {
+    const BatchResult& result = results[i];
+    output << jobs[i].name << " "
+           << kStopReasonNames[static_cast<int>(result.run.reason)] << " "
+           << result.run.instructions << " " << result.pc;
+    for (const RamRegion& region : result.ram) {
+      output << " " << region.address;
+      for (size_t j = 0; j < region.values.size(); j++) {
+        output << (j == 0 ? ":" : ",")
+               << static_cast<int16_t>(region.values[j]);
+      }
+    }
+    output << "\n";
+  }
+}
+
+}  // namespace hack
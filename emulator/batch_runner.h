@@ -0,0 +1,98 @@
+#ifndef EMULATOR_BATCH_RUNNER_H_
+#define EMULATOR_BATCH_RUNNER_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "emulator/cpu.h"
+#include "emulator/decode.h"
+
+namespace hack {
+
+// Consecutive words of RAM from `address`.
+struct RamRegion {
+  uint16_t address;
+  std::vector<uint16_t> values;
+};
+
+struct RamRange {
+  uint16_t address;
+  uint16_t count;
+};
+
+// One run of a program from a cleared machine.
+struct BatchJob {
+  std::string name;
+
+  // Index of the program in BatchManifest::rom_paths.
+  size_t program;
+
+  // Written to RAM before the run.
+  std::vector<RamRegion> initial_ram;
+
+  // RAM to report once the run stops.
+  std::vector<RamRange> dumps;
+
+  // Unset runs the job for BatchOptions::max_instructions.
+  std::optional<uint64_t> max_instructions;
+};
+
+struct BatchManifest {
+  // Each distinct ROM once, in order of first use.
+  std::vector<std::string> rom_paths;
+
+  std::vector<BatchJob> jobs;
+};
+
+// Parses a manifest with one job per line:
+//
+//   NAME ROM [max_instructions=N] [ram=ADDRESS:VALUE,...]...
+//       [dump=ADDRESS[:COUNT]]...
+//
+// ROM is a path as written, which jobs running the same program share. RAM
+// values may be negative. Blank lines and lines starting with '#' are
+// ignored. Returns nothing and describes the first problem in `error` if a
+// line is malformed or a name repeats.
+std::optional<BatchManifest> ParseManifest(std::string_view text,
+                                           std::string* error);
+
+struct BatchOptions {
+  int num_threads = 1;
+
+  // For jobs that do not set their own.
+  uint64_t max_instructions = UINT64_MAX;
+};
+
+struct BatchResult {
+  RunResult run;
+  uint16_t pc;
+
+  // The job's dumps, in order.
+  std::vector<RamRegion> ram;
+};
+
+// Runs every job on a work-stealing pool and returns the results in job
+// order. `programs` are the predecoded ROMs that BatchJob::program indexes;
+// jobs only read them, so each program is decoded once however many jobs
+// run it.
+std::vector<BatchResult> RunBatch(
+    const std::vector<std::shared_ptr<const std::vector<Op>>>& programs,
+    const std::vector<BatchJob>& jobs, const BatchOptions& options);
+
+// Writes one line per job:
+//
+//   NAME REASON INSTRUCTIONS PC [ADDRESS:VALUE,...]...
+//
+// with a region for each dump and signed values, as in the manifest.
+void WriteBatchResults(const std::vector<BatchJob>& jobs,
+                       const std::vector<BatchResult>& results,
+                       std::ostream& output);
+
+}  // namespace hack
+
+#endif  // EMULATOR_BATCH_RUNNER_H_
@@ -0,0 +1,202 @@
+#include "emulator/batch_runner.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/constexpr_assembler.h"
+#include "emulator/cpu.h"
+#include "emulator/decode.h"
+
+namespace hack {
+namespace {
+
+template <size_t N>
+std::shared_ptr<const std::vector<Op>> Program(
+    const std::array<uint16_t, N>& words) {
+  return std::make_shared<const std::vector<Op>>(
+      Predecode(std::vector<uint16_t>(words.begin(), words.end())));
+}
+
+// Adds 1 to RAM[0] into RAM[1], with the counter in RAM[2].
+constexpr std::string_view kSumTo = R"asm(
+  @2
+  M=1
+  @1
+  M=0
+(LOOP)
+  @2
+  D=M
+  @0
+  D=D-M
+  @END
+  D;JGT
+  @2
+  D=M
+  @1
+  M=D+M
+  @2
+  M=M+1
+  @LOOP
+  0;JMP
+(END)
+  @END
+  0;JMP
+)asm";
+
+// Copies RAM[0] to RAM[1].
+constexpr std::string_view kCopy = "@0\nD=M\n@1\nM=D\n(END)\n@END\n0;JMP\n";
+
+BatchManifest Parse(std::string_view text) {
+  std::string error;
+  std::optional<BatchManifest> manifest = ParseManifest(text, &error);
+  EXPECT_TRUE(manifest) << error;
+  return manifest.value_or(BatchManifest());
+}
+
+std::string ParseError(std::string_view text) {
+  std::string error;
+  EXPECT_FALSE(ParseManifest(text, &error));
+  return error;
+}
+
+TEST(ParseManifestTest, ParsesJobs) {
+  BatchManifest manifest = Parse(R"(
+# name rom options
+sum10   sum.hack ram=0:10 dump=1
+copy    copy.hack ram=0:-1 ram=100:1,2,3 dump=0:2 dump=100:3
+sum1000 sum.hack max_instructions=50 ram=0:1000
+)");
+
+  EXPECT_EQ(manifest.rom_paths, (std::vector<std::string>{"sum.hack",
+                                                          "copy.hack"}));
+  ASSERT_EQ(manifest.jobs.size(), 3);
+
+  const BatchJob& sum10 = manifest.jobs[0];
+  EXPECT_EQ(sum10.name, "sum10");
+  EXPECT_EQ(sum10.program, 0);
+  ASSERT_EQ(sum10.initial_ram.size(), 1);
+  EXPECT_EQ(sum10.initial_ram[0].address, 0);
+  EXPECT_EQ(sum10.initial_ram[0].values, std::vector<uint16_t>{10});
+  ASSERT_EQ(sum10.dumps.size(), 1);
+  EXPECT_EQ(sum10.dumps[0].address, 1);
+  EXPECT_EQ(sum10.dumps[0].count, 1);
+  EXPECT_FALSE(sum10.max_instructions);
+
+  const BatchJob& copy = manifest.jobs[1];
+  EXPECT_EQ(copy.program, 1);
+  ASSERT_EQ(copy.initial_ram.size(), 2);
+  EXPECT_EQ(copy.initial_ram[0].values, std::vector<uint16_t>{0xffff});
+  EXPECT_EQ(copy.initial_ram[1].address, 100);
+  EXPECT_EQ(copy.initial_ram[1].values, (std::vector<uint16_t>{1, 2, 3}));
+  ASSERT_EQ(copy.dumps.size(), 2);
+  EXPECT_EQ(copy.dumps[1].address, 100);
+  EXPECT_EQ(copy.dumps[1].count, 3);
+
+  EXPECT_EQ(manifest.jobs[2].program, 0);
+  EXPECT_EQ(manifest.jobs[2].max_instructions, 50);
+}
+
+TEST(ParseManifestTest, ReportsTheFirstBadLine) {
+  EXPECT_EQ(ParseError("a x.hack\nb\n"),
+            "Line 2: expected a job name and a ROM");
+  EXPECT_EQ(ParseError("a x.hack\na y.hack\n"),
+            "Line 2: job 'a' is defined more than once");
+  EXPECT_EQ(ParseError("a x.hack ram=5\n"), "Line 1: bad RAM region 'ram=5'");
+  EXPECT_EQ(ParseError("a x.hack ram=0:65536\n"),
+            "Line 1: bad RAM region 'ram=0:65536'");
+  EXPECT_EQ(ParseError("a x.hack ram=32767:1,2\n"),
+            "Line 1: bad RAM region 'ram=32767:1,2'");
+  EXPECT_EQ(ParseError("a x.hack dump=1:0\n"), "Line 1: bad dump 'dump=1:0'");
+  EXPECT_EQ(ParseError("a x.hack max_instructions=-1\n"),
+            "Line 1: bad instruction budget 'max_instructions=-1'");
+  EXPECT_EQ(ParseError("a x.hack verbose\n"),
+            "Line 1: unknown option 'verbose'");
+}
+
+TEST(RunBatchTest, RunsEachJobFromItsOwnInitialState) {
+  std::vector<std::shared_ptr<const std::vector<Op>>> programs = {
+    Program(HACK_ASSEMBLE(kSumTo)), Program(HACK_ASSEMBLE(kCopy))};
+  BatchManifest manifest = Parse(R"(
+sum10   sum ram=0:10 dump=1
+copy    copy ram=0:-7 dump=0:2
+sum100  sum ram=0:100 dump=1
+limited sum ram=0:100 dump=1 max_instructions=100
+)");
+  BatchOptions options;
+  options.num_threads = 4;
+
+  std::vector<BatchResult> results =
+      RunBatch(programs, manifest.jobs, options);
+
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_EQ(results[0].run.reason, StopReason::kHalted);
+  EXPECT_EQ(results[0].run.instructions, 4 + 10 * 14 + 6);
+  EXPECT_EQ(results[0].pc, 18);
+  EXPECT_EQ(results[0].ram[0].values, std::vector<uint16_t>{55});
+  EXPECT_EQ(results[1].ram[0].values,
+            (std::vector<uint16_t>{0xfff9, 0xfff9}));
+  EXPECT_EQ(results[2].ram[0].values, std::vector<uint16_t>{5050});
+  EXPECT_EQ(results[3].run.reason, StopReason::kInstructionLimit);
+  EXPECT_EQ(results[3].run.instructions, 100);
+
+  std::ostringstream output;
+  WriteBatchResults(manifest.jobs, results, output);
+  EXPECT_EQ(output.str(),
+            "sum10 halted 150 18 1:55\n"
+            "copy halted 4 4 0:-7,-7\n"
+            "sum100 halted 1410 18 1:5050\n"
+            "limited instruction_limit 100 " +
+                std::to_string(results[3].pc) + " 1:" +
+                std::to_string(results[3].ram[0].values[0]) + "\n");
+}
+
+TEST(RunBatchTest, DefaultBudgetAppliesToJobsWithoutTheirOwn) {
+  std::vector<std::shared_ptr<const std::vector<Op>>> programs = {
+    Program(HACK_ASSEMBLE(kSumTo))};
+  BatchManifest manifest = Parse(
+      "default sum ram=0:100\n"
+      "own sum ram=0:100 max_instructions=1000000\n");
+  BatchOptions options;
+  options.max_instructions = 10;
+
+  std::vector<BatchResult> results =
+      RunBatch(programs, manifest.jobs, options);
+
+  EXPECT_EQ(results[0].run.reason, StopReason::kInstructionLimit);
+  EXPECT_EQ(results[0].run.instructions, 10);
+  EXPECT_EQ(results[1].run.reason, StopReason::kHalted);
+}
+
+TEST(RunBatchTest, MatchesSequentialRunsOnManyThreads) {
+  std::vector<std::shared_ptr<const std::vector<Op>>> programs = {
+    Program(HACK_ASSEMBLE(kSumTo))};
+  std::string text;
+  for (int n = 0; n < 200; n++) {
+    // Budgets that cut some jobs off part way.
+    text += "job" + std::to_string(n) + " sum ram=0:" + std::to_string(n) +
+            " dump=0:3 max_instructions=" + std::to_string(50 * n) + "\n";
+  }
+  BatchManifest manifest = Parse(text);
+  BatchOptions sequential;
+  BatchOptions parallel;
+  parallel.num_threads = 8;
+
+  std::ostringstream expected;
+  WriteBatchResults(manifest.jobs,
+                    RunBatch(programs, manifest.jobs, sequential), expected);
+  std::ostringstream output;
+  WriteBatchResults(manifest.jobs,
+                    RunBatch(programs, manifest.jobs, parallel), output);
+
+  EXPECT_EQ(output.str(), expected.str());
+}
+
+}  // namespace
+}  // namespace hack
@@ -0,0 +1,309 @@
+#include "emulator/cpu.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "emulator/decode.h"
+
+namespace hack {
+
+namespace {
+
+// The jump bits are j1 (out < 0), j2 (out == 0) and j3 (out > 0); picks the
+// one that applies to `out`.
+inline bool Jumps(uint8_t jump, uint16_t out) {
+  int16_t value = out;
+  int shift = value < 0 ? 2 : value == 0 ? 1 : 0;
+  return (jump >> shift) & 1;
+}
+
+}  // namespace
+
+Cpu::Cpu(std::shared_ptr<const std::vector<Op>> program)
+    : program_(std::move(program)), ram_(kRamSize + 1) {
+  // Run keeps addresses, up to that of the kOpOutOfRom, in 16 bits.
+  if (program_->empty() || program_->size() > kRomSize + 1) {
+    std::abort();
+  }
+}
+
+Cpu::Cpu(const std::vector<uint16_t>& words)
+    : Cpu(std::make_shared<const std::vector<Op>>(Predecode(words))) {}
+
+void Cpu::Reset() {
+  pc_ = 0;
+  a_ = 0;
+  d_ = 0;
+  std::fill(ram_.begin(), ram_.end(), 0);
+}
+
+// Each handler ends by dispatching straight to the next one, so that with
+// computed goto every handler has its own indirect branch for the predictor
+// to learn. Other compilers get a switch in a loop.
+#if defined(__GNUC__)
+#define HANDLER(code) code##_handler:
+#define DISPATCH()                  \
+  do {                              \
+    if (remaining == 0) goto limit; \
+    remaining--;                    \
+    op = &ops[pc];                  \
+    goto *kHandlers[op->code];      \
+  } while (0)
+#define DISPATCH_BASE() goto *kHandlers[op->base]
+#else
+#define HANDLER(code) case code:
+#define DISPATCH() continue
+#define DISPATCH_BASE() \
+  do {                  \
+    code = op->base;    \
+    goto dispatch;      \
+  } while (0)
+#endif
+
+#define RAM(address) ram[(address) & kAddressMask]
+
+// Starts a superinstruction standing for `length` instructions. If fewer than
+// that remain, runs just the first one instead.
+#define BEGIN_FUSED(length)               \
+  do {                                    \
+    if (remaining < (length) - 1) {       \
+      DISPATCH_BASE();                    \
+    }                                     \
+    remaining -= (length) - 1;            \
+  } while (0)
+
+// The stack binary ops: @SP, M=M-1, A=M, D=M, A=A-1, M=`value`.
+#define STACK_BINARY(value) \
+  {                         \
+    BEGIN_FUSED(6);         \
+    RAM(0) -= 1;            \
+    a = RAM(0);             \
+    d = RAM(a);             \
+    a -= 1;                 \
+    RAM(a) = (value);       \
+    pc += 6;                \
+    DISPATCH();             \
+  }
+
+// Finishes a C-instruction whose comp is `value`. The M store goes to the
+// spare word when M is not a destination, and the jump reads A before the
+// instruction updates it, as in the hardware.
+#define COMMIT(value)                                                         \
+  {                                                                           \
+    uint16_t out = (value);                                                   \
+    ram[op->dest & kDestM ? a & kAddressMask : kRamSize] = out;               \
+    pc = Jumps(op->jump, out) ? std::min<uint16_t>(a & kAddressMask, end)     \
+                              : pc + 1;                                       \
+    a = op->dest & kDestA ? out : a;                                          \
+    d = op->dest & kDestD ? out : d;                                          \
+    DISPATCH();                                                               \
+  }
+
+#define MEMORY RAM(a)
+
+RunResult Cpu::Run(uint64_t max_instructions) {
+  const Op* ops = program_->data();
+  // Index of the kOpOutOfRom after the program, where jumps past it land.
+  const uint16_t end = program_->size() - 1;
+  uint16_t* ram = ram_.data();
+  uint16_t pc = pc_;
+  uint16_t a = a_;
+  uint16_t d = d_;
+  uint64_t remaining = max_instructions;
+  const Op* op;
+  StopReason reason;
+
+#if defined(__GNUC__)
+  // In OpCode order.
+  static const void* const kHandlers[kNumOpCodes] = {
+    &&kOpZero_handler, &&kOpOne_handler, &&kOpMinusOne_handler,
+    &&kOpD_handler, &&kOpA_handler, &&kOpM_handler,
+    &&kOpNotD_handler, &&kOpNotA_handler, &&kOpNotM_handler,
+    &&kOpNegD_handler, &&kOpNegA_handler, &&kOpNegM_handler,
+    &&kOpDPlusOne_handler, &&kOpAPlusOne_handler, &&kOpMPlusOne_handler,
+    &&kOpDMinusOne_handler, &&kOpAMinusOne_handler, &&kOpMMinusOne_handler,
+    &&kOpDPlusA_handler, &&kOpDPlusM_handler,
+    &&kOpDMinusA_handler, &&kOpDMinusM_handler,
+    &&kOpAMinusD_handler, &&kOpMMinusD_handler,
+    &&kOpDAndA_handler, &&kOpDAndM_handler,
+    &&kOpDOrA_handler, &&kOpDOrM_handler,
+    &&kOpAlu_handler, &&kOpLoadA_handler, &&kOpHalt_handler,
+    &&kOpOutOfRom_handler,
+    &&kOpPushD_handler, &&kOpPushDPreIncrement_handler, &&kOpPopToA_handler,
+    &&kOpPopD_handler, &&kOpStackAdd_handler, &&kOpStackSub_handler,
+    &&kOpStackAnd_handler, &&kOpStackOr_handler, &&kOpStackDiff_handler,
+    &&kOpStackNeg_handler, &&kOpStackNot_handler,
+  };
+  DISPATCH();
+#else
+  for (;;) {
+    if (remaining == 0) goto limit;
+    remaining--;
+    op = &ops[pc];
+    OpCode code = op->code;
+  dispatch:
+    switch (code) {
+#endif
+
+  HANDLER(kOpZero) COMMIT(0)
+  HANDLER(kOpOne) COMMIT(1)
+  HANDLER(kOpMinusOne) COMMIT(0xffff)
+  HANDLER(kOpD) COMMIT(d)
+  HANDLER(kOpA) COMMIT(a)
+  HANDLER(kOpM) COMMIT(MEMORY)
+  HANDLER(kOpNotD) COMMIT(~d)
+  HANDLER(kOpNotA) COMMIT(~a)
+  HANDLER(kOpNotM) COMMIT(~MEMORY)
+  HANDLER(kOpNegD) COMMIT(-d)
+  HANDLER(kOpNegA) COMMIT(-a)
+  HANDLER(kOpNegM) COMMIT(-MEMORY)
+  HANDLER(kOpDPlusOne) COMMIT(d + 1)
+  HANDLER(kOpAPlusOne) COMMIT(a + 1)
+  HANDLER(kOpMPlusOne) COMMIT(MEMORY + 1)
+  HANDLER(kOpDMinusOne) COMMIT(d - 1)
+  HANDLER(kOpAMinusOne) COMMIT(a - 1)
+  HANDLER(kOpMMinusOne) COMMIT(MEMORY - 1)
+  HANDLER(kOpDPlusA) COMMIT(d + a)
+  HANDLER(kOpDPlusM) COMMIT(d + MEMORY)
+  HANDLER(kOpDMinusA) COMMIT(d - a)
+  HANDLER(kOpDMinusM) COMMIT(d - MEMORY)
+  HANDLER(kOpAMinusD) COMMIT(a - d)
+  HANDLER(kOpMMinusD) COMMIT(MEMORY - d)
+  HANDLER(kOpDAndA) COMMIT(d & a)
+  HANDLER(kOpDAndM) COMMIT(d & MEMORY)
+  HANDLER(kOpDOrA) COMMIT(d | a)
+  HANDLER(kOpDOrM) COMMIT(d | MEMORY)
+  HANDLER(kOpAlu) COMMIT(EvaluateAlu(op->constant, d, a, MEMORY))
+
+  HANDLER(kOpLoadA) {
+    a = op->constant;
+    pc++;
+    DISPATCH();
+  }
+
+  // Superinstructions. Each does what its sequence does, in order, so that
+  // aliasing between the stack pointer and the slots it points at is honoured.
+
+  // @SP, A=M, M=D, @SP, M=M+1
+  HANDLER(kOpPushD) {
+    BEGIN_FUSED(5);
+    RAM(RAM(0)) = d;
+    RAM(0) += 1;
+    a = 0;
+    pc += 5;
+    DISPATCH();
+  }
+
+  // @SP, M=M+1, A=M-1, M=D
+  HANDLER(kOpPushDPreIncrement) {
+    BEGIN_FUSED(4);
+    RAM(0) += 1;
+    a = RAM(0) - 1;
+    RAM(a) = d;
+    pc += 4;
+    DISPATCH();
+  }
+
+  // D=A, @SP, A=M, M=D, A=A-1, D=M, A=A+1, A=M, M=D, @SP, M=M-1
+  HANDLER(kOpPopToA) {
+    BEGIN_FUSED(11);
+    d = a;
+    a = RAM(0);
+    RAM(a) = d;
+    a -= 1;
+    d = RAM(a);
+    a += 1;
+    a = RAM(a);
+    RAM(a) = d;
+    a = 0;
+    RAM(0) -= 1;
+    pc += 11;
+    DISPATCH();
+  }
+
+  // @address, AM=M-1, D=M
+  HANDLER(kOpPopD) {
+    BEGIN_FUSED(3);
+    a = RAM(op->constant) - 1;
+    RAM(op->constant) = a;
+    d = RAM(a);
+    pc += 3;
+    DISPATCH();
+  }
+
+  HANDLER(kOpStackAdd) STACK_BINARY(d + RAM(a))
+  HANDLER(kOpStackSub) STACK_BINARY(RAM(a) - d)
+  HANDLER(kOpStackAnd) STACK_BINARY(d & RAM(a))
+  HANDLER(kOpStackOr) STACK_BINARY(d | RAM(a))
+
+  // @SP, M=M-1, A=M, D=M, A=A-1, D=M-D
+  HANDLER(kOpStackDiff) {
+    BEGIN_FUSED(6);
+    RAM(0) -= 1;
+    a = RAM(0);
+    d = RAM(a);
+    a -= 1;
+    d = RAM(a) - d;
+    pc += 6;
+    DISPATCH();
+  }
+
+  // @SP, A=M-1, M=-M
+  HANDLER(kOpStackNeg) {
+    BEGIN_FUSED(3);
+    a = RAM(0) - 1;
+    RAM(a) = -RAM(a);
+    pc += 3;
+    DISPATCH();
+  }
+
+  // @SP, A=M-1, M=!M
+  HANDLER(kOpStackNot) {
+    BEGIN_FUSED(3);
+    a = RAM(0) - 1;
+    RAM(a) = ~RAM(a);
+    pc += 3;
+    DISPATCH();
+  }
+
+  // Neither of these executes an instruction.
+  HANDLER(kOpHalt) {
+    remaining++;
+    reason = StopReason::kHalted;
+    goto stop;
+  }
+  HANDLER(kOpOutOfRom) {
+    remaining++;
+    reason = StopReason::kOutOfRom;
+    goto stop;
+  }
+
+#if !defined(__GNUC__)
+      case kNumOpCodes:
+        break;
+    }
+  }
+#endif
+
+limit:
+  reason = StopReason::kInstructionLimit;
+stop:
+  pc_ = pc;
+  a_ = a;
+  d_ = d;
+  return {reason, max_instructions - remaining};
+}
+
+#undef MEMORY
+#undef COMMIT
+#undef STACK_BINARY
+#undef BEGIN_FUSED
+#undef RAM
+#undef DISPATCH_BASE
+#undef DISPATCH
+#undef HANDLER
+
+}  // namespace hack
@@ -0,0 +1,88 @@
+#ifndef EMULATOR_CPU_H_
+#define EMULATOR_CPU_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "emulator/decode.h"
+
+namespace hack {
+
+// Hack data memory: 16K of RAM, the 8K screen map and the keyboard register,
+// rounded up to the 32K addressable by a 15-bit address.
+inline constexpr size_t kRamSize = 0x8000;
+inline constexpr uint16_t kAddressMask = kRamSize - 1;
+
+// Why Cpu::Run returned.
+enum class StopReason {
+  // Reached an end-of-program loop (see kOpHalt).
+  kHalted,
+  // Ran or jumped past the last word of the program.
+  kOutOfRom,
+  // Executed the requested number of instructions.
+  kInstructionLimit,
+  // Only from recompiled programs: a computed jump went to an address the
+  // recompiler did not treat as the start of a block.
+  kUnknownJumpTarget,
+};
+
+struct RunResult {
+  StopReason reason;
+
+  // Number of instructions executed by this call.
+  uint64_t instructions;
+};
+
+// Emulates the Hack CPU running a predecoded program. The program is shared
+// and never modified, so many Cpus can run the same one.
+class Cpu {
+ public:
+  // `program` must come from Predecode; aborts if it is larger than kRomSize
+  // words and the kOpOutOfRom.
+  explicit Cpu(std::shared_ptr<const std::vector<Op>> program);
+
+  // Predecodes `words` for a Cpu of its own.
+  explicit Cpu(const std::vector<uint16_t>& words);
+
+  // Runs until the program halts or `max_instructions` have executed. A
+  // later call carries on from where this one stopped.
+  RunResult Run(uint64_t max_instructions = UINT64_MAX);
+
+  // Zeroes the registers and RAM.
+  void Reset();
+
+  uint16_t pc() const { return pc_; }
+  uint16_t a() const { return a_; }
+  uint16_t d() const { return d_; }
+
+  uint16_t ram(uint16_t address) const { return ram_[address & kAddressMask]; }
+  void set_ram(uint16_t address, uint16_t value) {
+    ram_[address & kAddressMask] = value;
+  }
+
+  // For execution engines that share this Cpu's state: the kRamSize words of
+  // RAM, and a way to set the registers. `pc` must not be past the end of the
+  // program.
+  uint16_t* ram_data() { return ram_.data(); }
+  void set_registers(uint16_t pc, uint16_t a, uint16_t d) {
+    pc_ = pc;
+    a_ = a;
+    d_ = d;
+  }
+
+ private:
+  std::shared_ptr<const std::vector<Op>> program_;
+
+  uint16_t pc_ = 0;
+  uint16_t a_ = 0;
+  uint16_t d_ = 0;
+
+  // kRamSize words, then one that C-instructions without an M destination
+  // write to, so that the store needs no branch.
+  std::vector<uint16_t> ram_;
+};
+
+}  // namespace hack
+
+#endif  // EMULATOR_CPU_H_
@@ -0,0 +1,108 @@
+// Benchmarks for the emulator's dispatch loop and JIT, reporting Hack
+// instructions executed per second.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "assembler/constexpr_assembler.h"
+#include "emulator/cpu.h"
+#include "emulator/decode.h"
+#include "emulator/jit.h"
+#include "emulator/test_programs.h"
+
+namespace hack {
+namespace {
+
+// Sets RAM[1024] to RAM[17407] to -1 through a pointer, as screen drawing does.
+constexpr std::string_view kFill = R"asm(
+  @1024
+  D=A
+  @pointer
+  M=D
+(LOOP)
+  @pointer
+  D=M
+  @17408
+  D=D-A
+  @END
+  D;JGE
+  @pointer
+  A=M
+  M=-1
+  @pointer
+  M=M+1
+  @LOOP
+  0;JMP
+(END)
+  @END
+  0;JMP
+)asm";
+
+// Sums with the translator's push, pop and arithmetic sequences, where
+// superinstructions pay off.
+constexpr int kTranslatedSumCount = 10000;
+
+void Run(benchmark::State& state, const std::vector<uint16_t>& words,
+         bool fuse = true) {
+  DecodeOptions options;
+  options.fuse = fuse;
+  Cpu cpu(std::make_shared<const std::vector<Op>>(Predecode(words, options)));
+  uint64_t instructions = 0;
+  for (auto _ : state) {
+    cpu.Reset();
+    instructions += cpu.Run().instructions;
+  }
+  state.SetItemsProcessed(instructions);
+}
+
+void BM_Sum(benchmark::State& state) {
+  Run(state, SumProgram(30000));
+}
+BENCHMARK(BM_Sum);
+
+void BM_Fill(benchmark::State& state) {
+  Run(state, ToVector(HACK_ASSEMBLE(kFill)));
+}
+BENCHMARK(BM_Fill);
+
+void BM_TranslatedSum(benchmark::State& state) {
+  static const auto* words = new std::vector<uint16_t>(
+      TranslatedProgram(kTranslatedSumCount));
+  Run(state, *words, /*fuse=*/state.range(0));
+}
+BENCHMARK(BM_TranslatedSum)->Arg(0)->Arg(1);
+
+// As Run, on a JitCpu. Blocks compiled in the first iteration stay compiled.
+void RunJit(benchmark::State& state, const std::vector<uint16_t>& words) {
+  JitCpu jit(words);
+  uint64_t instructions = 0;
+  for (auto _ : state) {
+    jit.Reset();
+    instructions += jit.Run().instructions;
+  }
+  state.SetItemsProcessed(instructions);
+  state.counters["compiled_blocks"] = jit.compiled_blocks();
+}
+
+void BM_JitSum(benchmark::State& state) {
+  RunJit(state, SumProgram(30000));
+}
+BENCHMARK(BM_JitSum);
+
+void BM_JitFill(benchmark::State& state) {
+  RunJit(state, ToVector(HACK_ASSEMBLE(kFill)));
+}
+BENCHMARK(BM_JitFill);
+
+void BM_JitTranslatedSum(benchmark::State& state) {
+  static const auto* words = new std::vector<uint16_t>(
+      TranslatedProgram(kTranslatedSumCount));
+  RunJit(state, *words);
+}
+BENCHMARK(BM_JitTranslatedSum);
+
+}  // namespace
+}  // namespace hack
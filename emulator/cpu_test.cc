@@ -0,0 +1,197 @@
+#include "emulator/cpu.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/code_tables.h"
+#include "assembler/constexpr_assembler.h"
+#include "emulator/decode.h"
+#include "emulator/test_programs.h"
+
+namespace hack {
+namespace {
+
+std::shared_ptr<const std::vector<Op>> Unfused(
+    const std::vector<uint16_t>& words) {
+  DecodeOptions options;
+  options.fuse = false;
+  return std::make_shared<const std::vector<Op>>(Predecode(words, options));
+}
+
+TEST(CpuTest, RunsUntilHalted) {
+  Cpu cpu(SumProgram(100));
+
+  RunResult result = cpu.Run();
+
+  EXPECT_EQ(result.reason, StopReason::kHalted);
+  EXPECT_EQ(result.instructions, 4 + 100 * 14 + 6);
+  EXPECT_EQ(cpu.ram(17), 5050);
+  EXPECT_EQ(cpu.ram(16), 101);
+  EXPECT_EQ(cpu.pc(), 18);
+
+  EXPECT_EQ(cpu.Run().instructions, 0);
+}
+
+TEST(CpuTest, ResumesAfterInstructionLimit) {
+  Cpu cpu(SumProgram(100));
+
+  uint64_t instructions = 0;
+  RunResult result;
+  do {
+    result = cpu.Run(33);
+    instructions += result.instructions;
+  } while (result.reason == StopReason::kInstructionLimit);
+
+  EXPECT_EQ(result.reason, StopReason::kHalted);
+  EXPECT_EQ(instructions, 4 + 100 * 14 + 6);
+  EXPECT_EQ(cpu.ram(17), 5050);
+}
+
+TEST(CpuTest, StopsOutsideTheProgram) {
+  Cpu falls_off(ToVector(HACK_ASSEMBLE("@1\nD=A\n")));
+  RunResult result = falls_off.Run();
+  EXPECT_EQ(result.reason, StopReason::kOutOfRom);
+  EXPECT_EQ(result.instructions, 2);
+  EXPECT_EQ(falls_off.d(), 1);
+
+  Cpu jumps_out(ToVector(HACK_ASSEMBLE("@1000\n0;JMP\n")));
+  EXPECT_EQ(jumps_out.Run().reason, StopReason::kOutOfRom);
+}
+
+TEST(CpuTest, RunsAFullRom) {
+  // @32767, 0;JMP, then @0 up to the last word.
+  std::vector<uint16_t> words(kRomSize);
+  words[0] = 0x7fff;
+  words[1] = 0xea87;
+  Cpu cpu(words);
+
+  RunResult result = cpu.Run();
+
+  EXPECT_EQ(result.reason, StopReason::kOutOfRom);
+  EXPECT_EQ(result.instructions, 3);
+  EXPECT_EQ(cpu.pc(), kRomSize);
+}
+
+TEST(CpuDeathTest, RejectsProgramsLargerThanTheRom) {
+  EXPECT_DEATH(Cpu(std::vector<uint16_t>(kRomSize + 1)), "");
+  auto too_large =
+      std::make_shared<const std::vector<Op>>(kRomSize + 2, Op{});
+  EXPECT_DEATH(Cpu{too_large}, "");
+}
+
+TEST(CpuTest, JumpsAndStoresUseTheOldA) {
+  Cpu cpu(ToVector(HACK_ASSEMBLE(R"asm(
+    @100
+    AM=A+1
+    @4
+    A=A+1;JMP
+    D=A
+    @5
+    0;JMP
+  )asm")));
+
+  EXPECT_EQ(cpu.Run().reason, StopReason::kHalted);
+  EXPECT_EQ(cpu.ram(100), 101);
+  EXPECT_EQ(cpu.ram(101), 0);
+  EXPECT_EQ(cpu.d(), 5);
+}
+
+TEST(CpuTest, MasksRamAddresses) {
+  Cpu cpu(ToVector(HACK_ASSEMBLE("@32767\nA=A+1\nM=-1\n")));
+
+  cpu.Run();
+
+  EXPECT_EQ(cpu.a(), 0x8000);
+  EXPECT_EQ(cpu.ram(0), 0xffff);
+}
+
+TEST(CpuTest, EveryCompMatchesTheAlu) {
+  std::vector<uint16_t> comps;
+  for (int i = 0; i < kNumCompOpCodes; i++) {
+    comps.push_back(code_internal::ParseBits(kCompTable[2 * i + 1]));
+  }
+  // Some that are not mnemonics.
+  comps.push_back(0b0000001);
+  comps.push_back(0b1000100);
+  comps.push_back(0b0111111 ^ 0b0000001);
+
+  for (uint16_t comp : comps) {
+    for (uint16_t d : {0, 1, 0x1234, 0x7fff}) {
+      for (uint16_t a : {0, 5, 0x7fff}) {
+        for (uint16_t m : {0, 3, 0xffff}) {
+          // D = d; A = a; D = comp.
+          Cpu cpu({d, 0xec10, a, static_cast<uint16_t>(0xe010 | comp << 6)});
+          cpu.set_ram(a, m);
+
+          cpu.Run();
+
+          EXPECT_EQ(cpu.d(), EvaluateAlu(comp, d, a, m))
+              << "comp " << comp << " d " << d << " a " << a << " m " << m;
+        }
+      }
+    }
+  }
+}
+
+TEST(CpuTest, SharesPrograms) {
+  auto program = std::make_shared<const std::vector<Op>>(
+      Predecode(SumProgram(100)));
+  Cpu first(program);
+  Cpu second(program);
+
+  first.Run();
+  second.Run(100);
+
+  EXPECT_EQ(first.ram(17), 5050);
+  EXPECT_EQ(second.ram(16), 8);
+  EXPECT_EQ(second.ram(17), 28);
+}
+
+TEST(CpuTest, ResetClearsState) {
+  Cpu cpu(SumProgram(100));
+  cpu.Run();
+
+  cpu.Reset();
+
+  EXPECT_EQ(cpu.pc(), 0);
+  EXPECT_EQ(cpu.ram(17), 0);
+  cpu.Run();
+  EXPECT_EQ(cpu.ram(17), 5050);
+}
+
+TEST(CpuTest, FusedProgramsMatchUnfused) {
+  std::vector<uint16_t> words = TranslatedProgram(20);
+  Cpu fused(words);
+  Cpu unfused(Unfused(words));
+
+  RunResult result = fused.Run();
+  RunResult expected = unfused.Run();
+
+  EXPECT_EQ(result.reason, StopReason::kHalted);
+  EXPECT_EQ(result.instructions, expected.instructions);
+  EXPECT_EQ(fused.ram(16), 190);
+  ASSERT_EQ(StateDifference(fused, unfused), "");
+}
+
+TEST(CpuTest, InstructionLimitsSplitFusedOps) {
+  std::vector<uint16_t> words = TranslatedProgram(3);
+  Cpu fused(words);
+  Cpu unfused(Unfused(words));
+
+  RunResult result;
+  do {
+    result = fused.Run(7);
+    EXPECT_EQ(unfused.Run(7).instructions, result.instructions);
+    ASSERT_EQ(StateDifference(fused, unfused), "");
+  } while (result.reason == StopReason::kInstructionLimit);
+
+  EXPECT_EQ(fused.ram(16), 3);
+}
+
+}  // namespace
+}  // namespace hack
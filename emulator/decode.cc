@@ -0,0 +1,180 @@
+#include "emulator/decode.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "assembler/code_tables.h"
+#include "assembler/constexpr_assembler.h"
+
+namespace hack {
+
+namespace {
+
+// Maps each of the 128 possible comp bit patterns to its opcode.
+constexpr std::array<OpCode, 128> BuildCompOpCodes() {
+  std::array<OpCode, 128> codes = {};
+  for (OpCode& code : codes) {
+    code = kOpAlu;
+  }
+  for (int i = 0; i < kNumCompOpCodes; i++) {
+    codes[code_internal::ParseBits(kCompTable[2 * i + 1])] =
+        static_cast<OpCode>(i);
+  }
+  return codes;
+}
+
+constexpr std::array<OpCode, 128> kCompOpCodes = BuildCompOpCodes();
+
+constexpr bool IsAInstruction(uint16_t word) { return (word & 0x8000) == 0; }
+
+// The sequences translator::CodeWriter emits for stack operations.
+constexpr auto kPushD = HACK_ASSEMBLE("@SP\nA=M\nM=D\n@SP\nM=M+1\n");
+constexpr auto kPushDPreIncrement = HACK_ASSEMBLE("@SP\nM=M+1\nA=M-1\nM=D\n");
+constexpr auto kPopToA = HACK_ASSEMBLE(
+    "D=A\n@SP\nA=M\nM=D\nA=A-1\nD=M\nA=A+1\nA=M\nM=D\n@SP\nM=M-1\n");
+constexpr auto kPopD = HACK_ASSEMBLE("@SP\nAM=M-1\nD=M\n");
+constexpr auto kStackAdd =
+    HACK_ASSEMBLE("@SP\nM=M-1\nA=M\nD=M\nA=A-1\nM=D+M\n");
+constexpr auto kStackSub =
+    HACK_ASSEMBLE("@SP\nM=M-1\nA=M\nD=M\nA=A-1\nM=M-D\n");
+constexpr auto kStackAnd =
+    HACK_ASSEMBLE("@SP\nM=M-1\nA=M\nD=M\nA=A-1\nM=D&M\n");
+constexpr auto kStackOr =
+    HACK_ASSEMBLE("@SP\nM=M-1\nA=M\nD=M\nA=A-1\nM=D|M\n");
+// The start of eq, gt and lt.
+constexpr auto kStackDiff =
+    HACK_ASSEMBLE("@SP\nM=M-1\nA=M\nD=M\nA=A-1\nD=M-D\n");
+constexpr auto kStackNeg = HACK_ASSEMBLE("@SP\nA=M-1\nM=-M\n");
+constexpr auto kStackNot = HACK_ASSEMBLE("@SP\nA=M-1\nM=!M\n");
+
+struct FusedSequence {
+  OpCode code;
+
+  const uint16_t* words;
+  size_t size;
+
+  // Whether the first word may be any A-instruction, not just words[0]. The
+  // fused op then takes the address from its constant.
+  bool any_address;
+};
+
+template <size_t N>
+constexpr FusedSequence Fuse(OpCode code, const std::array<uint16_t, N>& words,
+                             bool any_address = false) {
+  return {code, words.data(), N, any_address};
+}
+
+// Longest first, so that the first match at an address is the best one.
+constexpr FusedSequence kFusedSequences[] = {
+  Fuse(kOpPopToA, kPopToA),
+  Fuse(kOpStackAdd, kStackAdd),
+  Fuse(kOpStackSub, kStackSub),
+  Fuse(kOpStackAnd, kStackAnd),
+  Fuse(kOpStackOr, kStackOr),
+  Fuse(kOpStackDiff, kStackDiff),
+  Fuse(kOpPushD, kPushD),
+  Fuse(kOpPushDPreIncrement, kPushDPreIncrement),
+  // Also how return pops the saved frame through LCL.
+  Fuse(kOpPopD, kPopD, /*any_address=*/true),
+  Fuse(kOpStackNeg, kStackNeg),
+  Fuse(kOpStackNot, kStackNot),
+};
+
+bool Matches(const FusedSequence& sequence, const uint16_t* words,
+             size_t num_words) {
+  if (num_words < sequence.size) {
+    return false;
+  }
+  size_t i = 0;
+  if (sequence.any_address) {
+    if (!IsAInstruction(words[0])) {
+      return false;
+    }
+    i = 1;
+  }
+  for (; i < sequence.size; i++) {
+    if (words[i] != sequence.words[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Replaces the first op of each fused sequence in `ops`, which decodes
+// `words`. Sequences do not overlap.
+void FuseSequences(const std::vector<uint16_t>& words, std::vector<Op>& ops) {
+  for (size_t i = 0; i < words.size();) {
+    size_t length = 1;
+    for (const FusedSequence& sequence : kFusedSequences) {
+      if (Matches(sequence, &words[i], words.size() - i)) {
+        ops[i].code = sequence.code;
+        length = sequence.size;
+        break;
+      }
+    }
+    i += length;
+  }
+}
+
+}  // namespace
+
+int FusedLength(OpCode code) {
+  for (const FusedSequence& sequence : kFusedSequences) {
+    if (sequence.code == code) {
+      return sequence.size;
+    }
+  }
+  return 1;
+}
+
+Op DecodeWord(uint16_t word) {
+  if (IsAInstruction(word)) {
+    return {kOpLoadA, kOpLoadA, 0, 0, word};
+  }
+  uint16_t comp_bits = (word >> 6) & 0x7f;
+  OpCode code = kCompOpCodes[comp_bits];
+  return {code, code, static_cast<uint8_t>((word >> 3) & 7),
+          static_cast<uint8_t>(word & 7),
+          static_cast<uint16_t>(code == kOpAlu ? comp_bits : 0)};
+}
+
+std::vector<Op> Predecode(const std::vector<uint16_t>& words,
+                          const DecodeOptions& options) {
+  if (words.size() > kRomSize) {
+    std::abort();
+  }
+  std::vector<Op> ops;
+  ops.reserve(words.size() + 1);
+  for (uint16_t word : words) {
+    ops.push_back(DecodeWord(word));
+  }
+  for (size_t i = 0; i + 1 < ops.size(); i++) {
+    if (ops[i].code == kOpLoadA && ops[i].constant == i &&
+        !IsAInstruction(words[i + 1]) && ops[i + 1].dest == 0 &&
+        ops[i + 1].jump == 7) {
+      ops[i].code = kOpHalt;
+      ops[i].base = kOpHalt;
+    }
+  }
+  if (options.fuse) {
+    FuseSequences(words, ops);
+  }
+  ops.push_back({kOpOutOfRom, kOpOutOfRom, 0, 0, 0});
+  return ops;
+}
+
+uint16_t EvaluateAlu(uint16_t comp_bits, uint16_t d, uint16_t a, uint16_t m) {
+  uint16_t x = d;
+  uint16_t y = comp_bits & 0x40 ? m : a;
+  if (comp_bits & 0x20) x = 0;
+  if (comp_bits & 0x10) x = ~x;
+  if (comp_bits & 0x08) y = 0;
+  if (comp_bits & 0x04) y = ~y;
+  uint16_t out = comp_bits & 0x02 ? x + y : x & y;
+  if (comp_bits & 0x01) out = ~out;
+  return out;
+}
+
+}  // namespace hack
@@ -0,0 +1,136 @@
+#ifndef EMULATOR_DECODE_H_
+#define EMULATOR_DECODE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "assembler/code_tables.h"
+
+namespace hack {
+
+// What an Op does. The comp opcodes come first, one per entry of kCompTable
+// and in the same order, so that decoding is a lookup by table position and
+// the emulator cannot disagree with the assembler about what a mnemonic
+// encodes.
+enum OpCode : uint8_t {
+  kOpZero,
+  kOpOne,
+  kOpMinusOne,
+  kOpD,
+  kOpA,
+  kOpM,
+  kOpNotD,
+  kOpNotA,
+  kOpNotM,
+  kOpNegD,
+  kOpNegA,
+  kOpNegM,
+  kOpDPlusOne,
+  kOpAPlusOne,
+  kOpMPlusOne,
+  kOpDMinusOne,
+  kOpAMinusOne,
+  kOpMMinusOne,
+  kOpDPlusA,
+  kOpDPlusM,
+  kOpDMinusA,
+  kOpDMinusM,
+  kOpAMinusD,
+  kOpMMinusD,
+  kOpDAndA,
+  kOpDAndM,
+  kOpDOrA,
+  kOpDOrM,
+  // A C-instruction whose comp bits are not a mnemonic. The ALU control bits
+  // are kept in Op::constant and evaluated one by one.
+  kOpAlu,
+  // An A-instruction; Op::constant is the value.
+  kOpLoadA,
+  // An A-instruction that loads its own address, followed by an unconditional
+  // jump with no destination: the conventional end-of-program loop.
+  kOpHalt,
+  // Past the last word of the program.
+  kOpOutOfRom,
+  // Superinstructions: the start of one of the translator's stack idioms,
+  // executed in a single step. See kFusedSequences in decode.cc.
+  kOpPushD,
+  kOpPushDPreIncrement,
+  kOpPopToA,
+  kOpPopD,
+  kOpStackAdd,
+  kOpStackSub,
+  kOpStackAnd,
+  kOpStackOr,
+  kOpStackDiff,
+  kOpStackNeg,
+  kOpStackNot,
+  kNumOpCodes
+};
+
+inline constexpr int kNumCompOpCodes = kOpAlu;
+
+static_assert(kNumCompOpCodes * 2 == std::size(kCompTable));
+static_assert(kCompTable[2 * kOpMinusOne] == "-1");
+static_assert(kCompTable[2 * kOpNegM] == "-M");
+static_assert(kCompTable[2 * kOpMMinusOne] == "M-1");
+static_assert(kCompTable[2 * kOpMMinusD] == "M-D");
+static_assert(kCompTable[2 * kOpDOrM] == "D|M");
+
+// Hack ROM: the 32K words that a 15-bit A register can jump to.
+inline constexpr size_t kRomSize = 0x8000;
+
+// Bits of Op::dest.
+inline constexpr uint8_t kDestM = 1;
+inline constexpr uint8_t kDestD = 2;
+inline constexpr uint8_t kDestA = 4;
+
+// One predecoded ROM word.
+struct Op {
+  OpCode code;
+
+  // What the word does by itself. Differs from `code` only at the start of a
+  // fused sequence, and is run instead when a fused op would overrun an
+  // instruction limit.
+  OpCode base;
+
+  // The instruction's dest and jump bits, for C-instructions.
+  uint8_t dest;
+  uint8_t jump;
+
+  // The A-instruction value, or the comp bits for kOpAlu.
+  uint16_t constant;
+};
+
+// Decodes a single ROM word. Does not recognise kOpHalt, which depends on the
+// word's address and the word after it.
+Op DecodeWord(uint16_t word);
+
+struct DecodeOptions {
+  // Replace the first op of each of the translator's push, pop and stack
+  // arithmetic sequences with a superinstruction that runs the whole sequence.
+  bool fuse = true;
+};
+
+// Returns the number of words a fused opcode stands for, or 1.
+int FusedLength(OpCode code);
+
+// Decodes every word of `words`, marks end-of-program loops as kOpHalt, fuses
+// stack idioms if requested and appends a kOpOutOfRom. Aborts if `words` is
+// larger than kRomSize, which no Hack program can be; LoadRom rejects such
+// input gracefully.
+//
+// Words inside a fused sequence keep their own ops, so a jump into the middle
+// of one runs the rest an instruction at a time, and the machine state after
+// a superinstruction is exactly that after the sequence.
+std::vector<Op> Predecode(const std::vector<uint16_t>& words,
+                          const DecodeOptions& options = {});
+
+// Computes a C-instruction's comp from its 7 comp bits (a, c1-c6) the way the
+// Hack ALU does, one control bit at a time. Slow; for kOpAlu and for tests.
+uint16_t EvaluateAlu(uint16_t comp_bits, uint16_t d, uint16_t a, uint16_t m);
+
+}  // namespace hack
+
+#endif  // EMULATOR_DECODE_H_
@@ -0,0 +1,130 @@
+#include "emulator/decode.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/code_tables.h"
+#include "assembler/constexpr_assembler.h"
+#include "emulator/test_programs.h"
+
+namespace hack {
+namespace {
+
+TEST(DecodeTest, EveryCompMnemonicHasItsOwnOpCode) {
+  for (int i = 0; i < kNumCompOpCodes; i++) {
+    uint16_t comp_bits = code_internal::ParseBits(kCompTable[2 * i + 1]);
+
+    Op op = DecodeWord(0xe000 | comp_bits << 6);
+
+    EXPECT_EQ(op.code, i) << kCompTable[2 * i];
+  }
+}
+
+TEST(DecodeTest, DecodesFields) {
+  Op a_instruction = DecodeWord(0x7fff);
+  EXPECT_EQ(a_instruction.code, kOpLoadA);
+  EXPECT_EQ(a_instruction.constant, 0x7fff);
+
+  Op c_instruction = DecodeWord(HACK_ASSEMBLE("AM=D+M;JLE")[0]);
+  EXPECT_EQ(c_instruction.code, kOpDPlusM);
+  EXPECT_EQ(c_instruction.dest, kDestA | kDestM);
+  EXPECT_EQ(c_instruction.jump, 0b110);
+
+  // x & !y: not a mnemonic, so left to the ALU.
+  Op unnamed = DecodeWord(0xe000 | 0b0000100 << 6);
+  EXPECT_EQ(unnamed.code, kOpAlu);
+  EXPECT_EQ(unnamed.constant, 0b0000100);
+}
+
+TEST(DecodeTest, MarksEndOfProgramLoops) {
+  std::vector<Op> ops = Predecode(ToVector(HACK_ASSEMBLE(R"asm(
+    @2
+    0;JMP
+    (END)
+    @END
+    0;JMP
+    (WAIT)
+    @WAIT
+    D;JGT
+    @7
+    0;JMP
+  )asm")));
+
+  ASSERT_EQ(ops.size(), 9);
+  EXPECT_EQ(ops[0].code, kOpLoadA);
+  EXPECT_EQ(ops[2].code, kOpHalt);
+  EXPECT_EQ(ops[4].code, kOpLoadA);
+  EXPECT_EQ(ops[6].code, kOpLoadA);
+  EXPECT_EQ(ops[8].code, kOpOutOfRom);
+}
+
+TEST(DecodeDeathTest, RejectsProgramsLargerThanTheRom) {
+  EXPECT_EQ(Predecode(std::vector<uint16_t>(kRomSize)).size(), kRomSize + 1);
+  EXPECT_DEATH(Predecode(std::vector<uint16_t>(kRomSize + 1)), "");
+}
+
+TEST(DecodeTest, EvaluatesAluControlBits) {
+  EXPECT_EQ(EvaluateAlu(0b0101010, 7, 9, 11), 0);
+  EXPECT_EQ(EvaluateAlu(0b0111010, 7, 9, 11), 0xffff);
+  EXPECT_EQ(EvaluateAlu(0b0000010, 7, 9, 11), 16);
+  EXPECT_EQ(EvaluateAlu(0b1000010, 7, 9, 11), 18);
+  EXPECT_EQ(EvaluateAlu(0b1000111, 7, 9, 11), 4);
+  EXPECT_EQ(EvaluateAlu(0b0000001, 0x00ff, 0x0f0f, 0), 0xfff0);
+}
+
+TEST(DecodeTest, FusesStackIdioms) {
+  std::vector<uint16_t> words = ToVector(HACK_ASSEMBLE(R"asm(
+    @7
+    D=A
+    @SP
+    A=M
+    M=D
+    @SP
+    M=M+1
+    @SP
+    M=M-1
+    A=M
+    D=M
+    A=A-1
+    M=D+M
+    @SP
+    A=M-1
+    M=!M
+  )asm"));
+
+  std::vector<Op> ops = Predecode(words);
+
+  EXPECT_EQ(ops[0].code, kOpLoadA);
+  EXPECT_EQ(ops[2].code, kOpPushD);
+  EXPECT_EQ(ops[2].base, kOpLoadA);
+  EXPECT_EQ(ops[2].constant, 0);
+  EXPECT_EQ(ops[3].code, kOpM);
+  EXPECT_EQ(ops[7].code, kOpStackAdd);
+  EXPECT_EQ(ops[13].code, kOpStackNot);
+  EXPECT_EQ(FusedLength(kOpPushD), 5);
+  EXPECT_EQ(FusedLength(kOpStackAdd), 6);
+  EXPECT_EQ(FusedLength(kOpD), 1);
+
+  DecodeOptions options;
+  options.fuse = false;
+  std::vector<Op> unfused = Predecode(words, options);
+  for (const Op& op : unfused) {
+    EXPECT_EQ(op.code, op.base);
+  }
+}
+
+TEST(DecodeTest, FusesPopsThroughAnyPointer) {
+  std::vector<Op> ops = Predecode(ToVector(HACK_ASSEMBLE(R"asm(
+    @LCL
+    AM=M-1
+    D=M
+  )asm")));
+
+  EXPECT_EQ(ops[0].code, kOpPopD);
+  EXPECT_EQ(ops[0].constant, 1);
+}
+
+}  // namespace
+}  // namespace hack
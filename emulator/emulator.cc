@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "emulator/cpu.h"
+#include "emulator/jit.h"
+#include "emulator/rom_loader.h"
+#include "util/io/mapped_file.h"
+
+using ::hack::Cpu;
+using ::hack::JitCpu;
+using ::hack::LoadRom;
+using ::hack::RunResult;
+using ::hack::StopReason;
+using ::util_io::MappedFile;
+
+constexpr std::string_view kStopReasonNames[] = {
+  "halted", "out of rom", "instruction limit", "unknown jump target"};
+
+// Runs `machine` and reports on it as main describes, returning the exit code.
+template <typename Machine>
+int RunAndReport(Machine& machine, uint64_t max_instructions,
+                 uint16_t dump_start, uint16_t dump_count) {
+  RunResult result = machine.Run(max_instructions);
+  std::cout << kStopReasonNames[static_cast<int>(result.reason)] << " after "
+            << result.instructions << " instructions at pc " << machine.pc()
+            << std::endl;
+  for (int i = 0; i < dump_count; i++) {
+    uint16_t address = dump_start + i;
+    std::cout << "RAM[" << address << "] = "
+              << static_cast<int16_t>(machine.ram(address)) << std::endl;
+  }
+
+  return result.reason == StopReason::kInstructionLimit ? 4 : 0;
+}
+
+// Runs a .hack file or packed ROM image from a cleared machine, then prints
+// why it stopped, how many instructions it executed and the requested RAM.
+int main(int argc, char* argv[]) {
+  uint64_t max_instructions = UINT64_MAX;
+  uint16_t dump_start = 0;
+  uint16_t dump_count = 0;
+  bool jit = false;
+  std::optional<std::string> path;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg.substr(0, 19) == "--max_instructions=") {
+      max_instructions = std::strtoull(argv[i] + 19, nullptr, 10);
+    } else if (arg == "--jit") {
+      jit = true;
+    } else if (arg.substr(0, 7) == "--dump=") {
+      char* count;
+      dump_start = std::strtoul(argv[i] + 7, &count, 10);
+      dump_count = *count == ':' ? std::strtoul(count + 1, nullptr, 10) : 1;
+    } else if (!path && arg.substr(0, 2) != "--") {
+      path = arg;
+    } else {
+      path.reset();
+      break;
+    }
+  }
+  if (!path) {
+    std::cerr << "Usage: emulator [--max_instructions=N] "
+              << "[--dump=ADDRESS[:COUNT]] [--jit] <file>" << std::endl
+              << "  --max_instructions=N stops after N instructions if the "
+              << "program has not halted." << std::endl
+              << "  --dump=ADDRESS[:COUNT] prints COUNT words of RAM from "
+              << "ADDRESS once it stops." << std::endl
+              << "  --jit compiles hot code to native code where supported."
+              << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path absolute_path = std::filesystem::absolute(*path);
+  std::optional<MappedFile> input_file =
+      MappedFile::Open(absolute_path.string());
+  if (!input_file) {
+    std::cerr << "Could not open '" << absolute_path << "'" << std::endl;
+    return 2;
+  }
+  std::optional<std::vector<uint16_t>> words =
+      LoadRom(input_file->contents());
+  if (!words) {
+    std::cerr << "'" << absolute_path << "' is not a valid Hack program"
+              << std::endl;
+    return 3;
+  }
+
+  if (jit) {
+    JitCpu machine(*words);
+    return RunAndReport(machine, max_instructions, dump_start, dump_count);
+  }
+  Cpu machine(*words);
+  return RunAndReport(machine, max_instructions, dump_start, dump_count);
+}
@@ -0,0 +1,57 @@
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "emulator/recompiler.h"
+#include "emulator/rom_loader.h"
+#include "util/io/mapped_file.h"
+
+using ::hack::LoadRom;
+using ::hack::RecompileOptions;
+using ::hack::WriteRecompiledProgram;
+using ::util_io::MappedFile;
+
+// Translates a .hack file or packed ROM image into a C++ translation unit on
+// stdout. Build it with the host compiler and link it against code that
+// declares `extern const hack::RecompiledProgram NAME;`.
+int main(int argc, char* argv[]) {
+  RecompileOptions options;
+  std::optional<std::string_view> path;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg.substr(0, 7) == "--name=") {
+      options.name = arg.substr(7);
+    } else if (!path && arg.substr(0, 2) != "--") {
+      path = arg;
+    } else {
+      path.reset();
+      break;
+    }
+  }
+  if (!path || options.name.empty()) {
+    std::cerr << "Usage: hack_to_cpp [--name=IDENTIFIER] <file>" << std::endl
+              << "  --name=IDENTIFIER names the hack::RecompiledProgram the "
+              << "output defines." << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path absolute_path = std::filesystem::absolute(*path);
+  std::optional<MappedFile> input_file =
+      MappedFile::Open(absolute_path.string());
+  if (!input_file) {
+    std::cerr << "Could not open '" << absolute_path << "'" << std::endl;
+    return 2;
+  }
+  std::optional<std::vector<uint16_t>> words =
+      LoadRom(input_file->contents());
+  if (!words) {
+    std::cerr << "'" << absolute_path << "' is not a valid Hack program"
+              << std::endl;
+    return 3;
+  }
+  WriteRecompiledProgram(*words, options, std::cout);
+
+  return 0;
+}
@@ -0,0 +1,467 @@
+#include "emulator/jit.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "assembler/code_tables.h"
+#include "emulator/cpu.h"
+#include "emulator/decode.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define EMULATOR_JIT_X86_64 1
+#endif
+
+namespace hack {
+
+#if EMULATOR_JIT_X86_64
+
+namespace {
+
+// Host registers. A is kept in ecx, D in edx, the RAM base in rdi and the
+// Registers pointer in rsi until the prologue has loaded A and D from it. eax
+// holds the comp result and, on return, the next pc; ebx and esi are scratch.
+enum Reg : uint8_t {
+  kEax = 0,
+  kEcx = 1,
+  kEdx = 2,
+  kEbx = 3,
+  kEsi = 6,
+};
+
+// x86 condition codes for jumps on a 16-bit `out`, indexed by jump bits.
+// Invert one by flipping its low bit.
+constexpr uint8_t kConditionCodes[] = {
+  0x0,  // unused
+  0xf,  // JGT: g
+  0x4,  // JEQ: e
+  0xd,  // JGE: ge
+  0xc,  // JLT: l
+  0x5,  // JNE: ne
+  0xe,  // JLE: le
+  0x0,  // JMP: unconditional
+};
+
+constexpr uint8_t kJumpAlways = 7;
+
+// Appends machine code for the few instruction forms compiled blocks use.
+// Arithmetic is on 32-bit registers whose low 16 bits are the Hack value;
+// the high bits are don't-cares, masked off wherever they could matter.
+class Emitter {
+ public:
+  const std::vector<uint8_t>& code() const { return code_; }
+
+  void Prologue() {
+    Bytes({0x53, 0x56});              // push rbx; push rsi
+    Bytes({0x0f, 0xb7, 0x0e});        // movzx ecx, word [rsi]
+    Bytes({0x0f, 0xb7, 0x56, 0x02});  // movzx edx, word [rsi + 2]
+  }
+
+  // Returns with eax, the next pc, already set.
+  void Epilogue() {
+    Bytes({0x5e});                          // pop rsi
+    Bytes({0x66, 0x89, 0x0e});              // mov [rsi], cx
+    Bytes({0x66, 0x89, 0x56, 0x02, 0x5b});  // mov [rsi + 2], dx; pop rbx
+    Bytes({0xc3});                          // ret
+  }
+
+  void Mov(Reg dst, Reg src) { RegReg(0x89, dst, src); }
+  void Add(Reg dst, Reg src) { RegReg(0x01, dst, src); }
+  void Sub(Reg dst, Reg src) { RegReg(0x29, dst, src); }
+  void And(Reg dst, Reg src) { RegReg(0x21, dst, src); }
+  void Or(Reg dst, Reg src) { RegReg(0x09, dst, src); }
+  void Zero(Reg dst) { RegReg(0x31, dst, dst); }
+  void Not(Reg dst) { Bytes({0xf7, static_cast<uint8_t>(0xd0 | dst)}); }
+  void Neg(Reg dst) { Bytes({0xf7, static_cast<uint8_t>(0xd8 | dst)}); }
+  void Inc(Reg dst) { Bytes({0xff, static_cast<uint8_t>(0xc0 | dst)}); }
+  void Dec(Reg dst) { Bytes({0xff, static_cast<uint8_t>(0xc8 | dst)}); }
+
+  void Mov(Reg dst, uint32_t value) {
+    Bytes({static_cast<uint8_t>(0xb8 | dst)});
+    Imm32(value);
+  }
+
+  void MaskAddress(Reg dst) {
+    Bytes({0x81, static_cast<uint8_t>(0xe0 | dst)});
+    Imm32(kAddressMask);
+  }
+
+  // ebx = RAM[esi] and RAM[esi] = ax.
+  void LoadIndexed() { Bytes({0x0f, 0xb7, 0x1c, 0x77}); }
+  void StoreIndexed() { Bytes({0x66, 0x89, 0x04, 0x77}); }
+
+  // ebx = RAM[address] and RAM[address] = ax.
+  void Load(uint16_t address) {
+    Bytes({0x0f, 0xb7, 0x9f});
+    Imm32((address & kAddressMask) * 2);
+  }
+  void Store(uint16_t address) {
+    Bytes({0x66, 0x89, 0x87});
+    Imm32((address & kAddressMask) * 2);
+  }
+
+  // Sets the flags from ax.
+  void TestOut() { Bytes({0x66, 0x85, 0xc0}); }
+
+  // Emits a conditional jump and returns the position of its displacement,
+  // for Bind.
+  size_t JumpIf(uint8_t condition) {
+    Bytes({0x0f, static_cast<uint8_t>(0x80 | condition)});
+    Imm32(0);
+    return code_.size() - 4;
+  }
+
+  // Points the jump at `displacement` to the current position.
+  void Bind(size_t displacement) {
+    uint32_t offset = code_.size() - (displacement + 4);
+    std::memcpy(&code_[displacement], &offset, 4);
+  }
+
+ private:
+  void Bytes(std::initializer_list<uint8_t> bytes) {
+    code_.insert(code_.end(), bytes);
+  }
+
+  void Imm32(uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+      code_.push_back(value >> (8 * i));
+    }
+  }
+
+  void RegReg(uint8_t opcode, Reg dst, Reg src) {
+    Bytes({opcode, static_cast<uint8_t>(0xc0 | src << 3 | dst)});
+  }
+
+  std::vector<uint8_t> code_;
+};
+
+// Computes the comp of `op` into eax, with `y` holding A or M.
+void EmitComp(Emitter& emit, const Op& op, uint16_t comp_bits, Reg y) {
+  switch (op.base) {
+    case kOpZero:
+      emit.Zero(kEax);
+      return;
+    case kOpOne:
+      emit.Mov(kEax, 1u);
+      return;
+    case kOpMinusOne:
+      emit.Mov(kEax, 0xffffu);
+      return;
+    case kOpD:
+      emit.Mov(kEax, kEdx);
+      return;
+    case kOpA:
+    case kOpM:
+      emit.Mov(kEax, y);
+      return;
+    case kOpNotD:
+      emit.Mov(kEax, kEdx);
+      emit.Not(kEax);
+      return;
+    case kOpNotA:
+    case kOpNotM:
+      emit.Mov(kEax, y);
+      emit.Not(kEax);
+      return;
+    case kOpNegD:
+      emit.Mov(kEax, kEdx);
+      emit.Neg(kEax);
+      return;
+    case kOpNegA:
+    case kOpNegM:
+      emit.Mov(kEax, y);
+      emit.Neg(kEax);
+      return;
+    case kOpDPlusOne:
+      emit.Mov(kEax, kEdx);
+      emit.Inc(kEax);
+      return;
+    case kOpAPlusOne:
+    case kOpMPlusOne:
+      emit.Mov(kEax, y);
+      emit.Inc(kEax);
+      return;
+    case kOpDMinusOne:
+      emit.Mov(kEax, kEdx);
+      emit.Dec(kEax);
+      return;
+    case kOpAMinusOne:
+    case kOpMMinusOne:
+      emit.Mov(kEax, y);
+      emit.Dec(kEax);
+      return;
+    case kOpDPlusA:
+    case kOpDPlusM:
+      emit.Mov(kEax, kEdx);
+      emit.Add(kEax, y);
+      return;
+    case kOpDMinusA:
+    case kOpDMinusM:
+      emit.Mov(kEax, kEdx);
+      emit.Sub(kEax, y);
+      return;
+    case kOpAMinusD:
+    case kOpMMinusD:
+      emit.Mov(kEax, y);
+      emit.Sub(kEax, kEdx);
+      return;
+    case kOpDAndA:
+    case kOpDAndM:
+      emit.Mov(kEax, kEdx);
+      emit.And(kEax, y);
+      return;
+    case kOpDOrA:
+    case kOpDOrM:
+      emit.Mov(kEax, kEdx);
+      emit.Or(kEax, y);
+      return;
+    default:
+      break;
+  }
+  // kOpAlu: the control bits one at a time, as EvaluateAlu does.
+  if (comp_bits & 0x20) {
+    emit.Zero(kEax);
+  } else {
+    emit.Mov(kEax, kEdx);
+  }
+  if (comp_bits & 0x10) emit.Not(kEax);
+  if (comp_bits & 0x08) {
+    emit.Zero(kEbx);
+  } else if (y != kEbx) {
+    emit.Mov(kEbx, y);
+  }
+  if (comp_bits & 0x04) emit.Not(kEbx);
+  if (comp_bits & 0x02) {
+    emit.Add(kEax, kEbx);
+  } else {
+    emit.And(kEax, kEbx);
+  }
+  if (comp_bits & 0x01) emit.Not(kEax);
+}
+
+// Compiles the `length` instructions at `ops[address]`, of which only the last
+// may jump.
+std::vector<uint8_t> CompileBlock(const std::vector<Op>& ops, uint16_t address,
+                                  uint16_t length) {
+  Emitter emit;
+  emit.Prologue();
+  // The value of A, while the block has set it to a constant.
+  std::optional<uint16_t> known_a;
+  for (uint16_t pc = address; pc < address + length; pc++) {
+    const Op& op = ops[pc];
+    if (op.base == kOpLoadA) {
+      emit.Mov(kEcx, uint32_t{op.constant});
+      known_a = op.constant;
+      continue;
+    }
+
+    uint16_t comp_bits = op.base == kOpAlu
+        ? op.constant
+        : code_internal::ParseBits(kCompTable[2 * op.base + 1]);
+    bool reads_m = comp_bits & 0x40;
+    if (!known_a && (reads_m || (op.dest & kDestM))) {
+      emit.Mov(kEsi, kEcx);
+      emit.MaskAddress(kEsi);
+    }
+    if (reads_m) {
+      known_a ? emit.Load(*known_a) : emit.LoadIndexed();
+    }
+    EmitComp(emit, op, comp_bits, reads_m ? kEbx : kEcx);
+
+    // The jump and the M store use A as it was before this instruction.
+    std::optional<uint16_t> target = known_a;
+    if (op.jump != 0 && !target) {
+      emit.Mov(kEbx, kEcx);
+    }
+    if (op.dest & kDestM) {
+      known_a ? emit.Store(*known_a) : emit.StoreIndexed();
+    }
+    if (op.dest & kDestA) {
+      emit.Mov(kEcx, kEax);
+      known_a.reset();
+    }
+    if (op.dest & kDestD) {
+      emit.Mov(kEdx, kEax);
+    }
+    if (op.jump == 0) {
+      continue;
+    }
+
+    size_t not_taken = 0;
+    if (op.jump != kJumpAlways) {
+      emit.TestOut();
+      not_taken = emit.JumpIf(kConditionCodes[op.jump] ^ 1);
+    }
+    if (target) {
+      emit.Mov(kEax, uint32_t{static_cast<uint16_t>(*target & kAddressMask)});
+    } else {
+      emit.Mov(kEax, kEbx);
+      emit.MaskAddress(kEax);
+    }
+    emit.Epilogue();
+    if (op.jump == kJumpAlways) {
+      return emit.code();
+    }
+    emit.Bind(not_taken);
+    break;
+  }
+  emit.Mov(kEax, uint32_t{static_cast<uint16_t>(address + length)});
+  emit.Epilogue();
+  return emit.code();
+}
+
+}  // namespace
+
+// Executable memory, in mappings that are writable or executable but never
+// both at once.
+class JitCpu::CodeBuffer {
+ public:
+  ~CodeBuffer() {
+    for (const Chunk& chunk : chunks_) {
+      munmap(chunk.start, chunk.size);
+    }
+  }
+
+  // Copies `code` into executable memory and returns it, or null.
+  void* Add(const std::vector<uint8_t>& code) {
+    if (chunks_.empty() || chunks_.back().size - used_ < code.size()) {
+      size_t page = sysconf(_SC_PAGESIZE);
+      size_t size = std::max<size_t>(kChunkSize, code.size() + page - 1)
+          / page * page;
+      void* start = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (start == MAP_FAILED) {
+        return nullptr;
+      }
+      chunks_.push_back({static_cast<uint8_t*>(start), size});
+      used_ = 0;
+    } else if (mprotect(chunks_.back().start, chunks_.back().size,
+                        PROT_READ | PROT_WRITE) != 0) {
+      return nullptr;
+    }
+    Chunk& chunk = chunks_.back();
+    uint8_t* start = chunk.start + used_;
+    std::memcpy(start, code.data(), code.size());
+    // Keeps each block 16-byte aligned.
+    used_ += (code.size() + 15) & ~size_t{15};
+    if (mprotect(chunk.start, chunk.size, PROT_READ | PROT_EXEC) != 0) {
+      return nullptr;
+    }
+    return start;
+  }
+
+ private:
+  static constexpr size_t kChunkSize = 1 << 16;
+
+  struct Chunk {
+    uint8_t* start;
+    size_t size;
+  };
+
+  std::vector<Chunk> chunks_;
+  size_t used_ = 0;
+};
+
+bool JitCpu::Supported() { return true; }
+
+JitCpu::BlockFunction JitCpu::Compile(uint16_t address, uint16_t length) {
+  void* code = code_->Add(CompileBlock(*program_, address, length));
+  if (code == nullptr) {
+    return nullptr;
+  }
+  compiled_blocks_++;
+  return reinterpret_cast<BlockFunction>(code);
+}
+
+#else
+
+class JitCpu::CodeBuffer {};
+
+bool JitCpu::Supported() { return false; }
+
+JitCpu::BlockFunction JitCpu::Compile(uint16_t /*address*/,
+                                     uint16_t /*length*/) {
+  return nullptr;
+}
+
+#endif
+
+JitCpu::JitCpu(std::shared_ptr<const std::vector<Op>> program,
+               const JitOptions& options)
+    : program_(std::move(program)),
+      options_(options),
+      cpu_(program_),
+      blocks_(program_->size()),
+      code_(std::make_unique<CodeBuffer>()) {}
+
+JitCpu::JitCpu(const std::vector<uint16_t>& words, const JitOptions& options)
+    : JitCpu(std::make_shared<const std::vector<Op>>(Predecode(words)),
+             options) {}
+
+JitCpu::~JitCpu() = default;
+
+uint16_t JitCpu::BlockLength(uint16_t address) const {
+  const std::vector<Op>& ops = *program_;
+  uint16_t length = 0;
+  while (length < options_.max_block_length) {
+    const Op& op = ops[address + length];
+    if (op.base == kOpHalt || op.base == kOpOutOfRom) {
+      break;
+    }
+    length++;
+    if (op.base != kOpLoadA && op.jump != 0) {
+      break;
+    }
+  }
+  return std::max<uint16_t>(length, 1);
+}
+
+RunResult JitCpu::Run(uint64_t max_instructions) {
+  const std::vector<Op>& ops = *program_;
+  const uint32_t end = ops.size() - 1;
+  uint16_t* ram = cpu_.ram_data();
+  uint64_t remaining = max_instructions;
+  // Runs whole blocks; the interpreter finishes off, reporting why it stopped.
+  for (;;) {
+    uint16_t pc = cpu_.pc();
+    if (ops[pc].base == kOpHalt || ops[pc].base == kOpOutOfRom) {
+      break;
+    }
+    Block& block = blocks_[pc];
+    if (block.length == 0) {
+      block.length = BlockLength(pc);
+    }
+    if (remaining < block.length) {
+      break;
+    }
+    if (block.code == nullptr && block.entries < options_.hot_threshold &&
+        ++block.entries == options_.hot_threshold) {
+      block.code = Compile(pc, block.length);
+    }
+    if (block.code == nullptr) {
+      cpu_.Run(block.length);
+      remaining -= block.length;
+      continue;
+    }
+    // Chains through compiled blocks without touching the Cpu.
+    Registers registers = {cpu_.a(), cpu_.d()};
+    const Block* next = &block;
+    uint32_t next_pc;
+    do {
+      remaining -= next->length;
+      next_pc = std::min(next->code(ram, &registers), end);
+      next = &blocks_[next_pc];
+    } while (next->code != nullptr && remaining >= next->length);
+    cpu_.set_registers(next_pc, registers.a, registers.d);
+  }
+  RunResult result = cpu_.Run(remaining);
+  return {result.reason, max_instructions - remaining + result.instructions};
+}
+
+}  // namespace hack
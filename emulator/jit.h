@@ -0,0 +1,103 @@
+#ifndef EMULATOR_JIT_H_
+#define EMULATOR_JIT_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "emulator/cpu.h"
+#include "emulator/decode.h"
+
+namespace hack {
+
+struct JitOptions {
+  // Number of times a block is entered in the interpreter before it is
+  // compiled. 1 compiles every block the first time it runs.
+  int hot_threshold = 16;
+
+  // Longest block, in instructions, that is compiled as a unit.
+  int max_block_length = 64;
+};
+
+// A Cpu with a JIT tier: straight-line blocks that are run often are compiled
+// to x86-64 and run natively, and everything else is interpreted. Behaves
+// exactly as a Cpu running the same program does, including where it stops
+// for an instruction limit.
+//
+// A block starts wherever execution enters it and runs up to and including
+// the first jump. Compiled code keeps A and D in host registers and the base
+// of RAM in another, and returns the address of the next block; every jump,
+// computed or not, goes back through Run to find it.
+//
+// On hosts other than x86-64 Linux nothing is compiled.
+class JitCpu {
+ public:
+  explicit JitCpu(std::shared_ptr<const std::vector<Op>> program,
+                  const JitOptions& options = {});
+
+  // Predecodes `words` for a JitCpu of its own.
+  explicit JitCpu(const std::vector<uint16_t>& words,
+                  const JitOptions& options = {});
+
+  ~JitCpu();
+
+  JitCpu(const JitCpu&) = delete;
+  JitCpu& operator=(const JitCpu&) = delete;
+
+  // Whether this host can run compiled code at all.
+  static bool Supported();
+
+  // As Cpu::Run.
+  RunResult Run(uint64_t max_instructions = UINT64_MAX);
+
+  // Zeroes the registers and RAM. Compiled code is kept.
+  void Reset() { cpu_.Reset(); }
+
+  uint16_t pc() const { return cpu_.pc(); }
+  uint16_t a() const { return cpu_.a(); }
+  uint16_t d() const { return cpu_.d(); }
+
+  uint16_t ram(uint16_t address) const { return cpu_.ram(address); }
+  void set_ram(uint16_t address, uint16_t value) {
+    cpu_.set_ram(address, value);
+  }
+
+  // Number of blocks compiled so far.
+  int compiled_blocks() const { return compiled_blocks_; }
+
+ private:
+  class CodeBuffer;
+
+  // Registers passed to and from compiled code.
+  struct Registers {
+    uint16_t a;
+    uint16_t d;
+  };
+
+  // Returns the next pc.
+  using BlockFunction = uint32_t (*)(uint16_t* ram, Registers* registers);
+
+  struct Block {
+    // Instructions from the block's address up to and including the first
+    // jump. 0 until the block is first entered.
+    uint16_t length = 0;
+    int entries = 0;
+    BlockFunction code = nullptr;
+  };
+
+  uint16_t BlockLength(uint16_t address) const;
+  BlockFunction Compile(uint16_t address, uint16_t length);
+
+  const std::shared_ptr<const std::vector<Op>> program_;
+  const JitOptions options_;
+  Cpu cpu_;
+
+  // Indexed by address; the last entry is the kOpOutOfRom after the program.
+  std::vector<Block> blocks_;
+  std::unique_ptr<CodeBuffer> code_;
+  int compiled_blocks_ = 0;
+};
+
+}  // namespace hack
+
+#endif  // EMULATOR_JIT_H_
@@ -0,0 +1,177 @@
+#include "emulator/jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/constexpr_assembler.h"
+#include "emulator/cpu.h"
+#include "emulator/decode.h"
+#include "emulator/test_programs.h"
+
+namespace hack {
+namespace {
+
+JitOptions CompileEverything() {
+  JitOptions options;
+  options.hot_threshold = 1;
+  return options;
+}
+
+// Runs `words` to completion, or for `max_instructions`, on both engines and
+// compares everything.
+void ExpectSameRun(const std::vector<uint16_t>& words,
+                   const JitOptions& options,
+                   uint64_t max_instructions = UINT64_MAX) {
+  auto program = std::make_shared<const std::vector<Op>>(Predecode(words));
+  Cpu cpu(program);
+  JitCpu jit(program, options);
+
+  RunResult expected = cpu.Run(max_instructions);
+  RunResult result = jit.Run(max_instructions);
+
+  EXPECT_EQ(result.reason, expected.reason);
+  EXPECT_EQ(result.instructions, expected.instructions);
+  ASSERT_EQ(StateDifference(jit, cpu), "");
+}
+
+TEST(JitCpuTest, RunsUntilHalted) {
+  JitCpu jit(SumProgram(100), CompileEverything());
+
+  RunResult result = jit.Run();
+
+  EXPECT_EQ(result.reason, StopReason::kHalted);
+  EXPECT_EQ(result.instructions, 4 + 100 * 14 + 6);
+  EXPECT_EQ(jit.ram(17), 5050);
+  EXPECT_EQ(jit.pc(), 18);
+  if (JitCpu::Supported()) {
+    EXPECT_GT(jit.compiled_blocks(), 0);
+  }
+
+  EXPECT_EQ(jit.Run().instructions, 0);
+}
+
+TEST(JitCpuTest, CompilesOnlyHotBlocks) {
+  JitOptions options;
+  options.hot_threshold = 50;
+  JitCpu jit(SumProgram(100), options);
+  EXPECT_EQ(jit.Run().reason, StopReason::kHalted);
+  EXPECT_EQ(jit.ram(17), 5050);
+  // The loop's two blocks, not the set-up or the exit.
+  EXPECT_EQ(jit.compiled_blocks(), JitCpu::Supported() ? 2 : 0);
+
+  options.hot_threshold = 0;
+  JitCpu interpreted(SumProgram(100), options);
+  EXPECT_EQ(interpreted.Run().reason, StopReason::kHalted);
+  EXPECT_EQ(interpreted.compiled_blocks(), 0);
+}
+
+TEST(JitCpuTest, MatchesTheInterpreter) {
+  for (int threshold : {0, 1, 3}) {
+    JitOptions options;
+    options.hot_threshold = threshold;
+    ExpectSameRun(SumProgram(100), options);
+    ExpectSameRun(TranslatedProgram(20), options);
+  }
+}
+
+TEST(JitCpuTest, StopsAtTheSameInstructionLimits) {
+  std::vector<uint16_t> words = TranslatedProgram(20);
+  auto program = std::make_shared<const std::vector<Op>>(Predecode(words));
+  for (uint64_t step : {1, 2, 7, 64, 1000}) {
+    Cpu cpu(program);
+    JitCpu jit(program, CompileEverything());
+    RunResult expected;
+    do {
+      expected = cpu.Run(step);
+      RunResult result = jit.Run(step);
+      ASSERT_EQ(result.reason, expected.reason);
+      ASSERT_EQ(result.instructions, expected.instructions);
+      ASSERT_EQ(jit.pc(), cpu.pc());
+      ASSERT_EQ(jit.a(), cpu.a());
+      ASSERT_EQ(jit.d(), cpu.d());
+    } while (expected.reason == StopReason::kInstructionLimit);
+    ASSERT_EQ(StateDifference(jit, cpu), "");
+  }
+}
+
+TEST(JitCpuTest, JumpsAndStoresUseTheOldA) {
+  ExpectSameRun(ToVector(HACK_ASSEMBLE(R"asm(
+    @100
+    AM=A+1
+    @4
+    A=A+1;JMP
+    D=A
+    @5
+    0;JMP
+  )asm")), CompileEverything());
+  ExpectSameRun(ToVector(HACK_ASSEMBLE("@32767\nA=A+1\nM=-1\n")),
+                CompileEverything());
+  ExpectSameRun(ToVector(HACK_ASSEMBLE("@1000\nD=A\n0;JMP\n")),
+                CompileEverything());
+}
+
+TEST(JitCpuTest, ResetKeepsCompiledCode) {
+  JitCpu jit(SumProgram(100), CompileEverything());
+  jit.Run();
+  int compiled = jit.compiled_blocks();
+
+  jit.Reset();
+  EXPECT_EQ(jit.ram(17), 0);
+  EXPECT_EQ(jit.Run().reason, StopReason::kHalted);
+  EXPECT_EQ(jit.ram(17), 5050);
+  EXPECT_EQ(jit.compiled_blocks(), compiled);
+}
+
+// Random words over every comp, dest and jump, with A-instructions mostly
+// aimed inside the program and at the first few RAM words so that jumps and
+// memory operands interact.
+std::vector<uint16_t> RandomProgram(std::mt19937& random, int size) {
+  std::vector<uint16_t> words;
+  for (int i = 0; i < size; i++) {
+    uint16_t word = random();
+    switch (random() % 4) {
+      case 0:
+        words.push_back(random() % (size + 2));
+        break;
+      case 1:
+        words.push_back(word & 0x7fff);
+        break;
+      default:
+        // Jump less often than not, to get longer blocks.
+        words.push_back(0xe000 | (word & 0x1ff8) |
+                        (random() % 3 == 0 ? word & 7 : 0));
+        break;
+    }
+  }
+  return words;
+}
+
+TEST(JitCpuTest, RandomProgramsMatchTheInterpreter) {
+  std::mt19937 random(20261018);
+  for (int i = 0; i < 300; i++) {
+    std::vector<uint16_t> words = RandomProgram(random, 1 + random() % 60);
+    auto program = std::make_shared<const std::vector<Op>>(Predecode(words));
+    Cpu cpu(program);
+    JitCpu jit(program, CompileEverything());
+    for (uint16_t address = 0; address < 64; address++) {
+      uint16_t value = random();
+      cpu.set_ram(address, value);
+      jit.set_ram(address, value);
+    }
+
+    RunResult expected = cpu.Run(5000);
+    RunResult result = jit.Run(5000);
+
+    ASSERT_EQ(result.reason, expected.reason) << i;
+    ASSERT_EQ(result.instructions, expected.instructions) << i;
+    ASSERT_EQ(StateDifference(jit, cpu), "") << i;
+  }
+}
+
+}  // namespace
+}  // namespace hack
@@ -0,0 +1,39 @@
+// Compares the interpreter with the recompiled testdata/Fib.vm.
+
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "emulator/cpu.h"
+#include "emulator/recompiled_program.h"
+
+extern const hack::RecompiledProgram kFib;
+
+namespace hack {
+namespace {
+
+void BM_InterpretedFib(benchmark::State& state) {
+  Cpu cpu(std::vector<uint16_t>(kFib.words, kFib.words + kFib.size));
+  uint64_t instructions = 0;
+  for (auto _ : state) {
+    cpu.Reset();
+    instructions += cpu.Run().instructions;
+  }
+  state.SetItemsProcessed(instructions);
+}
+BENCHMARK(BM_InterpretedFib);
+
+void BM_RecompiledFib(benchmark::State& state) {
+  std::vector<uint16_t> ram(kRamSize);
+  uint64_t instructions = 0;
+  for (auto _ : state) {
+    std::fill(ram.begin(), ram.end(), 0);
+    instructions += kFib.run(ram.data(), UINT64_MAX).instructions;
+  }
+  state.SetItemsProcessed(instructions);
+}
+BENCHMARK(BM_RecompiledFib);
+
+}  // namespace
+}  // namespace hack
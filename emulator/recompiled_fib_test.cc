@@ -0,0 +1,45 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "emulator/cpu.h"
+#include "emulator/recompiled_program.h"
+
+// testdata/Fib.vm, translated, assembled and recompiled by the fib_* rules.
+extern const hack::RecompiledProgram kFib;
+
+namespace hack {
+namespace {
+
+TEST(RecompiledFibTest, MatchesTheInterpreter) {
+  Cpu cpu(std::vector<uint16_t>(kFib.words, kFib.words + kFib.size));
+  RunResult expected = cpu.Run();
+  std::vector<uint16_t> ram(kRamSize);
+
+  RecompiledRun run = kFib.run(ram.data(), UINT64_MAX);
+
+  EXPECT_EQ(run.reason, StopReason::kHalted);
+  EXPECT_EQ(run.reason, expected.reason);
+  EXPECT_EQ(run.instructions, expected.instructions);
+  EXPECT_EQ(run.pc, cpu.pc());
+  EXPECT_EQ(run.a, cpu.a());
+  EXPECT_EQ(run.d, cpu.d());
+  EXPECT_EQ(ram[16], 6765);
+  for (size_t address = 0; address < kRamSize; address++) {
+    ASSERT_EQ(ram[address], cpu.ram(address)) << address;
+  }
+}
+
+TEST(RecompiledFibTest, StopsAtBlockBeforeInstructionLimit) {
+  std::vector<uint16_t> ram(kRamSize);
+
+  RecompiledRun run = kFib.run(ram.data(), 1000);
+
+  EXPECT_EQ(run.reason, StopReason::kInstructionLimit);
+  EXPECT_LE(run.instructions, 1000);
+  EXPECT_GT(run.instructions, 900);
+}
+
+}  // namespace
+}  // namespace hack
@@ -0,0 +1,37 @@
+#ifndef EMULATOR_RECOMPILED_PROGRAM_H_
+#define EMULATOR_RECOMPILED_PROGRAM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "emulator/cpu.h"
+
+namespace hack {
+
+// The machine state when a recompiled program stops.
+struct RecompiledRun {
+  StopReason reason;
+
+  uint64_t instructions;
+
+  uint16_t pc;
+  uint16_t a;
+  uint16_t d;
+};
+
+// A program translated to C++ by hack_to_cpp. The generated translation unit
+// defines one of these under the name given to the tool.
+struct RecompiledProgram {
+  // The ROM it was translated from.
+  const uint16_t* words;
+  size_t size;
+
+  // Runs the program from reset over `ram`, which must hold kRamSize words.
+  // The instruction limit is checked on entry to each basic block, so the run
+  // stops at the start of the first block that would exceed it.
+  RecompiledRun (*run)(uint16_t* ram, uint64_t max_instructions);
+};
+
+}  // namespace hack
+
+#endif  // EMULATOR_RECOMPILED_PROGRAM_H_
@@ -0,0 +1,296 @@
+#include "emulator/recompiler.h"
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "assembler/code_tables.h"
+#include "emulator/decode.h"
+
+namespace hack {
+
+namespace {
+
+constexpr std::string_view kMemory = "ram[a & 0x7fff]";
+
+// C++ for each named comp, in OpCode order.
+constexpr std::string_view kCompExpressions[] = {
+  "0", "1", "0xffff",
+  "d", "a", kMemory,
+  "~d", "~a", "~ram[a & 0x7fff]",
+  "-d", "-a", "-ram[a & 0x7fff]",
+  "d + 1", "a + 1", "ram[a & 0x7fff] + 1",
+  "d - 1", "a - 1", "ram[a & 0x7fff] - 1",
+  "d + a", "d + ram[a & 0x7fff]",
+  "d - a", "d - ram[a & 0x7fff]",
+  "a - d", "ram[a & 0x7fff] - d",
+  "d & a", "d & ram[a & 0x7fff]",
+  "d | a", "d | ram[a & 0x7fff]",
+};
+
+static_assert(std::size(kCompExpressions) == kNumCompOpCodes);
+
+// C++ testing `out` for each jump, indexed by the jump bits.
+constexpr std::string_view kJumpConditions[] = {
+  "false",
+  "static_cast<int16_t>(out) > 0",
+  "out == 0",
+  "static_cast<int16_t>(out) >= 0",
+  "static_cast<int16_t>(out) < 0",
+  "out != 0",
+  "static_cast<int16_t>(out) <= 0",
+  "true",
+};
+
+constexpr uint8_t kJumpAlways = 7;
+
+// Spells out the ALU's control bits for comps without a mnemonic.
+std::string AluExpression(uint16_t comp_bits) {
+  std::string x = comp_bits & 0x20 ? "0" : "d";
+  std::string y = comp_bits & 0x08 ? "0"
+      : comp_bits & 0x40 ? std::string(kMemory) : "a";
+  if (comp_bits & 0x10) x = "~" + x;
+  if (comp_bits & 0x04) y = "~" + y;
+  std::string out = "(" + x + (comp_bits & 0x02 ? " + " : " & ") + y + ")";
+  return comp_bits & 0x01 ? "~" + out : out;
+}
+
+// Looks up the mnemonic for `bits` in one of the code tables.
+template <size_t N>
+std::string_view Mnemonic(const std::string_view (&table)[N], uint16_t bits) {
+  for (size_t i = 0; i < N; i += 2) {
+    if (code_internal::ParseBits(table[i + 1]) == bits) {
+      return table[i];
+    }
+  }
+  return "?";
+}
+
+// Returns the assembly for `word`, for comments in the generated code.
+std::string Disassemble(uint16_t word) {
+  if ((word & 0x8000) == 0) {
+    return "@" + std::to_string(word);
+  }
+  std::string text;
+  std::string_view dest = Mnemonic(kDestTable, (word >> 3) & 7);
+  if (!dest.empty()) {
+    text.append(dest).append("=");
+  }
+  text.append(Mnemonic(kCompTable, (word >> 6) & 0x7f));
+  std::string_view jump = Mnemonic(kJumpTable, word & 7);
+  if (!jump.empty()) {
+    text.append(";").append(jump);
+  }
+  return text;
+}
+
+class Recompiler {
+ public:
+  Recompiler(const std::vector<uint16_t>& words, std::ostream& output)
+      : words_(words),
+        ops_(Predecode(words, NoFusion())),
+        block_starts_(FindBlockStarts(words)),
+        output_(output) {}
+
+  void WriteRunFunction() {
+    output_ << "hack::RecompiledRun Run(uint16_t* ram, "
+            << "uint64_t max_instructions) {\n"
+            << "  uint16_t a = 0;\n"
+            << "  uint16_t d = 0;\n"
+            << "  uint16_t pc = 0;\n"
+            << "  uint16_t out;\n"
+            << "  uint64_t remaining = max_instructions;\n"
+            << "  hack::StopReason reason;\n";
+    // Entering through the dispatch switch references every label.
+    output_ << "  goto dispatch;\n";
+    for (size_t address = 0; address < words_.size(); address++) {
+      if (block_starts_[address]) {
+        WriteBlockStart(address);
+      }
+      if (ops_[address].code != kOpHalt) {
+        WriteInstruction(address);
+      }
+    }
+    // Running off the end.
+    output_ << "  goto out_of_rom;\n\n";
+    WriteDispatch();
+    // Like Cpu, leaves pc just past the program however it got there.
+    output_ << "out_of_rom:\n"
+            << "  pc = " << words_.size() << ";\n"
+            << "  reason = hack::StopReason::kOutOfRom;\n"
+            << "  goto stop;\n"
+            << "unknown_target:\n"
+            << "  reason = hack::StopReason::kUnknownJumpTarget;\n"
+            << "  goto stop;\n";
+    if (halts_) {
+      output_ << "halted:\n"
+              << "  reason = hack::StopReason::kHalted;\n"
+              << "  goto stop;\n";
+    }
+    if (!words_.empty()) {
+      output_ << "limit:\n"
+              << "  reason = hack::StopReason::kInstructionLimit;\n"
+              << "  goto stop;\n";
+    }
+    output_ << "stop:\n"
+            << "  return {reason, max_instructions - remaining, pc, a, d};\n"
+            << "}\n";
+  }
+
+ private:
+  static DecodeOptions NoFusion() {
+    DecodeOptions options;
+    options.fuse = false;
+    return options;
+  }
+
+  // Number of instructions from `address` to the end of its block.
+  size_t BlockLength(size_t address) const {
+    size_t end = address + 1;
+    while (end < words_.size() && !block_starts_[end]) {
+      end++;
+    }
+    return end - address;
+  }
+
+  void WriteBlockStart(size_t address) {
+    known_a_.reset();
+    output_ << "\nL" << address << ":\n";
+    if (ops_[address].code == kOpHalt) {
+      output_ << "  pc = " << address << ";\n"
+              << "  goto halted;\n";
+      halts_ = true;
+      // Unreachable, but keeps the loop's jump direct.
+      known_a_ = address;
+      return;
+    }
+    size_t length = BlockLength(address);
+    output_ << "  if (remaining < " << length << ") {\n"
+            << "    pc = " << address << ";\n"
+            << "    goto limit;\n"
+            << "  }\n"
+            << "  remaining -= " << length << ";\n";
+  }
+
+  void WriteInstruction(size_t address) {
+    const Op& op = ops_[address];
+    output_ << "  // " << address << ": " << Disassemble(words_[address])
+            << "\n";
+    if (op.code == kOpLoadA) {
+      output_ << "  a = " << op.constant << ";\n";
+      known_a_ = op.constant;
+      return;
+    }
+
+    std::string comp = op.code == kOpAlu
+        ? AluExpression(op.constant)
+        : std::string(kCompExpressions[op.code]);
+    output_ << "  out = " << comp << ";\n";
+    // The jump reads A as it was before this instruction.
+    std::optional<uint16_t> target = known_a_;
+    bool jumps = op.jump != 0;
+    if (jumps && !target) {
+      output_ << "  pc = a & 0x7fff;\n";
+    }
+    if (op.dest & kDestM) {
+      output_ << "  " << kMemory << " = out;\n";
+    }
+    if (op.dest & kDestA) {
+      output_ << "  a = out;\n";
+      known_a_.reset();
+    }
+    if (op.dest & kDestD) {
+      output_ << "  d = out;\n";
+    }
+    if (!jumps) {
+      return;
+    }
+    std::string_view indent = "  ";
+    if (op.jump != kJumpAlways) {
+      output_ << "  if (" << kJumpConditions[op.jump] << ") {\n";
+      indent = "    ";
+    }
+    if (!target) {
+      output_ << indent << "goto dispatch;\n";
+    } else if ((*target & 0x7fff) < words_.size()) {
+      output_ << indent << "goto L" << (*target & 0x7fff) << ";\n";
+    } else {
+      output_ << indent << "goto out_of_rom;\n";
+    }
+    if (op.jump != kJumpAlways) {
+      output_ << "  }\n";
+    }
+  }
+
+  // Computed jumps land here with the target in `pc`.
+  void WriteDispatch() {
+    output_ << "dispatch:\n"
+            << "  switch (pc) {\n";
+    for (size_t address = 0; address < words_.size(); address++) {
+      if (block_starts_[address]) {
+        output_ << "    case " << address << ": goto L" << address << ";\n";
+      }
+    }
+    output_ << "  }\n"
+            << "  if (pc >= " << words_.size() << ") goto out_of_rom;\n"
+            << "  goto unknown_target;\n\n";
+  }
+
+  const std::vector<uint16_t>& words_;
+  const std::vector<Op> ops_;
+  const std::vector<bool> block_starts_;
+  std::ostream& output_;
+
+  // The value of A, while the code since the start of the block has set it
+  // to a constant.
+  std::optional<uint16_t> known_a_;
+
+  bool halts_ = false;
+};
+
+}  // namespace
+
+std::vector<bool> FindBlockStarts(const std::vector<uint16_t>& words) {
+  std::vector<bool> starts(words.size());
+  if (!words.empty()) {
+    starts[0] = true;
+  }
+  for (size_t address = 0; address < words.size(); address++) {
+    uint16_t word = words[address];
+    if ((word & 0x8000) == 0) {
+      if (word < words.size()) {
+        starts[word] = true;
+      }
+    } else if ((word & 7) != 0 && address + 1 < words.size()) {
+      starts[address + 1] = true;
+    }
+  }
+  return starts;
+}
+
+void WriteRecompiledProgram(const std::vector<uint16_t>& words,
+                            const RecompileOptions& options,
+                            std::ostream& output) {
+  output << "// Generated by hack_to_cpp. Do not edit.\n\n"
+         << "#include <cstdint>\n\n"
+         << "#include \"emulator/recompiled_program.h\"\n\n"
+         << "namespace {\n\n"
+         << "constexpr uint16_t kWords[] = {";
+  for (size_t i = 0; i < words.size(); i++) {
+    output << (i % 8 == 0 ? "\n  " : " ") << words[i] << ",";
+  }
+  if (words.empty()) {
+    // Arrays cannot be empty; `size` is still 0.
+    output << "0";
+  }
+  output << "\n};\n\n";
+  Recompiler(words, output).WriteRunFunction();
+  output << "\n}  // namespace\n\n"
+         << "extern const hack::RecompiledProgram " << options.name
+         << " = {kWords, " << words.size() << ", &Run};\n";
+}
+
+}  // namespace hack
@@ -0,0 +1,33 @@
+#ifndef EMULATOR_RECOMPILER_H_
+#define EMULATOR_RECOMPILER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hack {
+
+// Returns, for each address of `words`, whether it starts a basic block:
+// address 0, the word after each jump, and every address that an
+// A-instruction loads. The last covers direct jumps as well as computed ones
+// such as returns through "A=M; 0;JMP", whose targets were loaded as
+// constants when they were saved.
+std::vector<bool> FindBlockStarts(const std::vector<uint16_t>& words);
+
+struct RecompileOptions {
+  // Name of the RecompiledProgram the translation unit defines.
+  std::string name = "kRecompiledProgram";
+};
+
+// Writes a C++ translation unit that runs `words` natively: each basic block
+// becomes straight-line code behind a label, jumps to constant addresses
+// become gotos, and computed jumps go through a switch over the block starts.
+// See recompiled_program.h for the interface it defines.
+void WriteRecompiledProgram(const std::vector<uint16_t>& words,
+                            const RecompileOptions& options,
+                            std::ostream& output);
+
+}  // namespace hack
+
+#endif  // EMULATOR_RECOMPILER_H_
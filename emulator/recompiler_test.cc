@@ -0,0 +1,80 @@
+#include "emulator/recompiler.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/constexpr_assembler.h"
+#include "emulator/test_programs.h"
+
+namespace hack {
+namespace {
+
+constexpr std::string_view kCallAndReturn = R"asm(
+    @RETURN
+    D=A
+    @R15
+    M=D
+    @FUNCTION
+    0;JMP
+  (RETURN)
+    @END
+    0;JMP
+  (FUNCTION)
+    @R15
+    A=M
+    0;JMP
+  (END)
+    @END
+    0;JMP
+)asm";
+
+TEST(RecompilerTest, FindsBlocksAtJumpTargetsAndAfterJumps) {
+  std::vector<bool> starts = FindBlockStarts(ToVector(HACK_ASSEMBLE(
+      kCallAndReturn)));
+
+  // Entry, the saved return address, and the targets of and words after the
+  // direct jumps. R15 is past the end of the program.
+  std::vector<bool> expected(13);
+  for (int address : {0, 6, 8, 11}) {
+    expected[address] = true;
+  }
+  EXPECT_EQ(starts, expected);
+}
+
+TEST(RecompilerTest, WritesDirectAndComputedJumps) {
+  RecompileOptions options;
+  options.name = "kCallAndReturn";
+  std::ostringstream output;
+
+  WriteRecompiledProgram(ToVector(HACK_ASSEMBLE(kCallAndReturn)), options,
+                         output);
+
+  std::string code = output.str();
+  EXPECT_NE(code.find("  // 5: 0;JMP\n  out = 0;\n  goto L8;\n"),
+            std::string::npos);
+  EXPECT_NE(code.find("  // 10: 0;JMP\n  out = 0;\n  pc = a & 0x7fff;\n"
+                      "  goto dispatch;\n"),
+            std::string::npos);
+  EXPECT_NE(code.find("    case 6: goto L6;\n"), std::string::npos);
+  EXPECT_NE(code.find("L11:\n  pc = 11;\n  goto halted;\n"),
+            std::string::npos);
+  EXPECT_NE(code.find("extern const hack::RecompiledProgram kCallAndReturn = "
+                      "{kWords, 13, &Run};"),
+            std::string::npos);
+}
+
+TEST(RecompilerTest, WritesEmptyPrograms) {
+  std::ostringstream output;
+
+  WriteRecompiledProgram({}, RecompileOptions(), output);
+
+  EXPECT_NE(output.str().find("{kWords, 0, &Run}"), std::string::npos);
+  EXPECT_EQ(output.str().find("limit:"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace hack
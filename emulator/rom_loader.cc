@@ -0,0 +1,24 @@
+#include "emulator/rom_loader.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "assembler/rom_image.h"
+#include "emulator/decode.h"
+
+namespace hack {
+
+std::optional<std::vector<uint16_t>> LoadRom(std::string_view data) {
+  std::optional<std::vector<uint16_t>> words =
+      data.substr(0, kRomImageMagic.size()) == kRomImageMagic
+          ? ReadRomImage(data)
+          : ReadHackText(data);
+  if (words && words->size() > kRomSize) {
+    return {};
+  }
+  return words;
+}
+
+}  // namespace hack
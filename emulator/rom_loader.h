@@ -0,0 +1,18 @@
+#ifndef EMULATOR_ROM_LOADER_H_
+#define EMULATOR_ROM_LOADER_H_
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace hack {
+
+// Decodes assembler output in either format: a packed ROM image, recognised
+// by its magic, or .hack text. Returns nothing if `data` is malformed or the
+// program does not fit in the 32K ROM.
+std::optional<std::vector<uint16_t>> LoadRom(std::string_view data);
+
+}  // namespace hack
+
+#endif  // EMULATOR_ROM_LOADER_H_
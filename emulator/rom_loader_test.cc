@@ -0,0 +1,46 @@
+#include "emulator/rom_loader.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "assembler/rom_image.h"
+
+namespace hack {
+namespace {
+
+const std::vector<uint16_t> kWords = {0x0002, 0xec10, 0x0003, 0xe090};
+
+TEST(RomLoaderTest, LoadsHackText) {
+  std::ostringstream text;
+  WriteHackText(kWords, text);
+
+  EXPECT_EQ(LoadRom(text.str()), kWords);
+}
+
+TEST(RomLoaderTest, LoadsRomImage) {
+  std::ostringstream image;
+  WriteRomImage(kWords, image);
+
+  EXPECT_EQ(LoadRom(image.str()), kWords);
+}
+
+TEST(RomLoaderTest, RejectsMalformedInput) {
+  std::ostringstream image;
+  WriteRomImage(kWords, image);
+
+  EXPECT_EQ(LoadRom(image.str().substr(0, 20)), std::nullopt);
+  EXPECT_EQ(LoadRom("@2\nD=A\n"), std::nullopt);
+}
+
+TEST(RomLoaderTest, RejectsProgramsLargerThanRom) {
+  std::ostringstream image;
+  WriteRomImage(std::vector<uint16_t>(0x8001), image);
+
+  EXPECT_EQ(LoadRom(image.str()), std::nullopt);
+}
+
+}  // namespace
+}  // namespace hack
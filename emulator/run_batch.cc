@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "emulator/batch_runner.h"
+#include "emulator/decode.h"
+#include "emulator/rom_loader.h"
+#include "util/io/mapped_file.h"
+
+using ::hack::BatchManifest;
+using ::hack::BatchOptions;
+using ::hack::BatchResult;
+using ::hack::LoadRom;
+using ::hack::Op;
+using ::hack::ParseManifest;
+using ::hack::Predecode;
+using ::hack::RunBatch;
+using ::hack::WriteBatchResults;
+using ::util_io::MappedFile;
+
+// Runs every job in a manifest (see hack::ParseManifest) and writes one line
+// of results per job, in manifest order, to the output file. ROM paths are
+// relative to the manifest, and each ROM is loaded and predecoded once.
+int main(int argc, char* argv[]) {
+  BatchOptions options;
+  std::vector<std::string_view> paths;
+  bool usage_error = false;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg.substr(0, 10) == "--threads=") {
+      options.num_threads = std::atoi(argv[i] + 10);
+      if (options.num_threads == 0) {
+        options.num_threads = std::thread::hardware_concurrency();
+      }
+    } else if (arg.substr(0, 19) == "--max_instructions=") {
+      options.max_instructions = std::strtoull(argv[i] + 19, nullptr, 10);
+    } else if (arg.substr(0, 2) != "--") {
+      paths.push_back(arg);
+    } else {
+      usage_error = true;
+    }
+  }
+  if (usage_error || paths.size() != 2) {
+    std::cerr << "Usage: run_batch [--threads=N] [--max_instructions=N] "
+              << "<manifest> <output>" << std::endl
+              << "  --threads=N runs jobs on N threads (0 for one per core)."
+              << std::endl
+              << "  --max_instructions=N stops jobs that set no budget of "
+              << "their own after N instructions." << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path manifest_path = std::filesystem::absolute(paths[0]);
+  std::optional<MappedFile> manifest_file =
+      MappedFile::Open(manifest_path.string());
+  if (!manifest_file) {
+    std::cerr << "Could not open '" << manifest_path << "'" << std::endl;
+    return 2;
+  }
+  std::string error;
+  std::optional<BatchManifest> manifest =
+      ParseManifest(manifest_file->contents(), &error);
+  if (!manifest) {
+    std::cerr << manifest_path << ": " << error << std::endl;
+    return 3;
+  }
+
+  std::vector<std::shared_ptr<const std::vector<Op>>> programs;
+  for (const std::string& rom_path : manifest->rom_paths) {
+    std::filesystem::path path = manifest_path.parent_path() / rom_path;
+    std::optional<MappedFile> rom_file = MappedFile::Open(path.string());
+    if (!rom_file) {
+      std::cerr << "Could not open '" << path << "'" << std::endl;
+      return 2;
+    }
+    std::optional<std::vector<uint16_t>> words = LoadRom(rom_file->contents());
+    if (!words) {
+      std::cerr << "'" << path << "' is not a valid Hack program" << std::endl;
+      return 3;
+    }
+    programs.push_back(
+        std::make_shared<const std::vector<Op>>(Predecode(*words)));
+  }
+
+  // Opened first so that a bad path fails before the batch runs.
+  std::string output_path(paths[1]);
+  std::ofstream output(output_path);
+  if (!output) {
+    std::cerr << "Could not open '" << output_path << "' for writing"
+              << std::endl;
+    return 2;
+  }
+  std::vector<BatchResult> results =
+      RunBatch(programs, manifest->jobs, options);
+  WriteBatchResults(manifest->jobs, results, output);
+  output.close();
+  if (!output) {
+    std::cerr << "Could not write '" << output_path << "'" << std::endl;
+    return 2;
+  }
+  return 0;
+}
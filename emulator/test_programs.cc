@@ -0,0 +1,88 @@
+#include "emulator/test_programs.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "assembler/assemble.h"
+#include "translator/code_writer.h"
+
+namespace hack {
+
+std::vector<uint16_t> SumProgram(int n) {
+  return Assemble(R"asm(
+  @i
+  M=1
+  @sum
+  M=0
+(LOOP)
+  @i
+  D=M
+  @)asm" + std::to_string(n) + R"asm(
+  D=D-A
+  @END
+  D;JGT
+  @i
+  D=M
+  @sum
+  M=D+M
+  @i
+  M=M+1
+  @LOOP
+  0;JMP
+(END)
+  @END
+  0;JMP
+)asm").words;
+}
+
+std::vector<uint16_t> TranslatedProgram(int n) {
+  std::ostringstream assembly;
+  translator::CodeWriter writer(assembly);
+  writer.SetFileName("Main.vm");
+  writer.WriteBootstrap();
+
+  writer.WriteFunction("Sys.init", 0);
+  writer.WritePush("constant", n);
+  writer.WriteCall("Main.sum", 1);
+  writer.WritePop("static", 0);
+  writer.WritePush("constant", 0);
+  writer.WriteReturn();
+
+  writer.WriteFunction("Main.sum", 2);
+  writer.WriteLabel("LOOP");
+  writer.WritePush("local", 1);
+  writer.WritePush("argument", 0);
+  writer.WriteArithmetic("lt");
+  writer.WriteArithmetic("not");
+  writer.WriteIf("DONE");
+  writer.WritePush("local", 0);
+  writer.WritePush("local", 1);
+  writer.WriteArithmetic("add");
+  writer.WritePop("local", 0);
+  writer.WritePush("local", 1);
+  writer.WritePush("constant", 1);
+  writer.WriteArithmetic("add");
+  writer.WritePop("local", 1);
+  writer.WritePush("local", 0);
+  writer.WriteArithmetic("neg");
+  writer.WritePush("constant", 255);
+  writer.WriteArithmetic("and");
+  writer.WritePush("local", 1);
+  writer.WriteArithmetic("or");
+  writer.WritePush("local", 1);
+  writer.WriteArithmetic("sub");
+  writer.WritePush("constant", 0);
+  writer.WriteArithmetic("eq");
+  writer.WritePop("temp", 0);
+  writer.WriteGoto("LOOP");
+  writer.WriteLabel("DONE");
+  writer.WritePush("local", 0);
+  writer.WriteReturn();
+  writer.Close();
+
+  return Assemble(assembly.str()).words;
+}
+
+}  // namespace hack
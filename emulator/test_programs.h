@@ -0,0 +1,58 @@
+#ifndef EMULATOR_TEST_PROGRAMS_H_
+#define EMULATOR_TEST_PROGRAMS_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "emulator/cpu.h"
+
+namespace hack {
+
+// Copies the words that HACK_ASSEMBLE returns into a vector.
+template <size_t N>
+std::vector<uint16_t> ToVector(const std::array<uint16_t, N>& words) {
+  return std::vector<uint16_t>(words.begin(), words.end());
+}
+
+// Adds 1 to `n` into RAM[17], using RAM[16] as the counter: a branchy loop
+// over a few variables. Halts at address 18 after 4 + 14 * n + 6
+// instructions.
+std::vector<uint16_t> SumProgram(int n);
+
+// Translates a VM program that sums 0 to n - 1 in a called function, using
+// every push, pop and arithmetic idiom, and stores the result in static 0,
+// i.e. RAM[16].
+std::vector<uint16_t> TranslatedProgram(int n);
+
+// Describes the first difference in pc, registers or RAM between two
+// machines, such as a Cpu and a JitCpu, or returns "" if there is none.
+template <typename Machine, typename ExpectedMachine>
+std::string StateDifference(const Machine& machine,
+                            const ExpectedMachine& expected) {
+  auto describe = [](const char* what, int value, int expected_value) {
+    return std::string(what) + " is " + std::to_string(value) +
+           ", expected " + std::to_string(expected_value);
+  };
+  if (machine.pc() != expected.pc()) {
+    return describe("pc", machine.pc(), expected.pc());
+  }
+  if (machine.a() != expected.a()) {
+    return describe("A", machine.a(), expected.a());
+  }
+  if (machine.d() != expected.d()) {
+    return describe("D", machine.d(), expected.d());
+  }
+  for (size_t address = 0; address < kRamSize; address++) {
+    if (machine.ram(address) != expected.ram(address)) {
+      return describe(("RAM[" + std::to_string(address) + "]").c_str(),
+                      machine.ram(address), expected.ram(address));
+    }
+  }
+  return "";
+}
+
+}  // namespace hack
+
+#endif  // EMULATOR_TEST_PROGRAMS_H_
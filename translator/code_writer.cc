@@ -17,6 +17,8 @@ enum class Arity {
 struct Op {
   std::string_view command;
   
+  // For unary ops, the operator applied to M. For binary ops, the whole comp,
+  // written the way the assembler's mnemonic table spells it.
   std::string_view op;
 
   Arity arity;
@@ -43,25 +45,25 @@ constexpr std::string_view kPointerSymbolByOffset[] = {
 constexpr Op kOps[] = {
   {
     "add",
-    "+",
+    "D+M",
     Arity::kBinary,
     "Add the top two elements of the stack."
   },
   {
     "sub",
-    "-",
+    "M-D",
     Arity::kBinary,
     "Subtract the top element from the second to top element of the stack."
   },
   {
     "and",
-    "&",
+    "D&M",
     Arity::kBinary,
     "Performs bit-wise and on the top two elements of the stack."
   },
   {
     "or",
-    "|",
+    "D|M",
     Arity::kBinary,
     "Performs bit-wise or on the top two elements of the stack."
   },
@@ -138,7 +140,7 @@ M=M-1
 A=M
 D=M
 A=A-1
-M=M)asm" << op.op << R"asm(D
+M=)asm" << op.op << R"asm(
 
 )asm";
     }
@@ -266,7 +268,7 @@ void CodeWriter::WriteFunction(std::string_view function_name, int n_vars) {
     output_ << "@" << n_vars << std::endl
             << "D=A" << std::endl
             << "@SP" << std::endl
-            << "M=M+D" << std::endl;
+            << "M=D+M" << std::endl;
   }
 }
 
@@ -207,7 +207,7 @@ M=M-1
 A=M
 D=M
 A=A-1
-M=M+D
+M=D+M
 
 )asm");
 }
@@ -241,7 +241,7 @@ M=M-1
 A=M
 D=M
 A=A-1
-M=M&D
+M=D&M
 
 )asm");
 }
@@ -258,7 +258,7 @@ M=M-1
 A=M
 D=M
 A=A-1
-M=M|D
+M=D|M
 
 )asm");
 }
@@ -0,0 +1,116 @@
+#ifndef UTIL_CONCURRENCY_SPSC_RING_H_
+#define UTIL_CONCURRENCY_SPSC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace util_concurrency {
+
+// A bounded queue between exactly one producer thread and one consumer thread.
+// It needs no locks: each index is written by only one side, and the other
+// side reads it with acquire ordering to see the slot contents.
+//
+// Push and Pop wait for space or items by spinning briefly and then yielding,
+// which suits stages that exchange large batches rather than single items.
+template <typename T>
+class SpscRing final {
+ public:
+  // Holds up to `capacity` items, rounded up to a power of two.
+  explicit SpscRing(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+      size *= 2;
+    }
+    slots_.resize(size);
+    mask_ = size - 1;
+  }
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  // Producer only. Adds `value` unless the ring is full.
+  bool TryPush(T& value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > mask_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Producer only. Adds `value`, waiting for space if the ring is full.
+  void Push(T value) {
+    for (int spins = 0; !TryPush(value); spins++) {
+      Wait(spins);
+    }
+  }
+
+  // Producer only. Tells the consumer that nothing more will be pushed.
+  void Close() {
+    closed_.store(true, std::memory_order_release);
+  }
+
+  // Consumer only. Moves the oldest item into `value` unless the ring is
+  // empty.
+  bool TryPop(T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        return false;
+      }
+    }
+    value = std::move(slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Moves the oldest item into `value`, waiting for one if the
+  // ring is empty. Returns false once the ring is closed and drained.
+  bool Pop(T& value) {
+    for (int spins = 0; !TryPop(value); spins++) {
+      if (closed_.load(std::memory_order_acquire)) {
+        // Close happens after the last push, so check once more.
+        return TryPop(value);
+      }
+      Wait(spins);
+    }
+    return true;
+  }
+
+ private:
+  static void Wait(int spins) {
+    if (spins >= 64) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::vector<T> slots_;
+
+  size_t mask_ = 0;
+
+  // Next slot to pop. Written only by the consumer.
+  alignas(64) std::atomic<size_t> head_{0};
+
+  // The producer's last view of head_.
+  size_t cached_head_ = 0;
+
+  // Next slot to push. Written only by the producer.
+  alignas(64) std::atomic<size_t> tail_{0};
+
+  // The consumer's last view of tail_.
+  size_t cached_tail_ = 0;
+
+  std::atomic<bool> closed_{false};
+};
+
+}  // namespace util_concurrency
+
+#endif  // UTIL_CONCURRENCY_SPSC_RING_H_
@@ -0,0 +1,76 @@
+#include "util/concurrency/spsc_ring.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace util_concurrency {
+namespace {
+
+TEST(SpscRingTest, RoundsCapacityUpToPowerOfTwo) {
+  SpscRing<int> ring(3);
+  int value = 0;
+  for (int i = 0; i < 4; i++) {
+    value = i;
+    EXPECT_TRUE(ring.TryPush(value));
+  }
+  value = 4;
+  EXPECT_FALSE(ring.TryPush(value));
+
+  EXPECT_TRUE(ring.TryPop(value));
+  EXPECT_EQ(value, 0);
+  value = 4;
+  EXPECT_TRUE(ring.TryPush(value));
+}
+
+TEST(SpscRingTest, PopReturnsFalseOnceClosedAndDrained) {
+  SpscRing<int> ring(4);
+  ring.Push(1);
+  ring.Push(2);
+  ring.Close();
+
+  int value = 0;
+  EXPECT_TRUE(ring.Pop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_TRUE(ring.Pop(value));
+  EXPECT_EQ(value, 2);
+  EXPECT_FALSE(ring.Pop(value));
+}
+
+TEST(SpscRingTest, MovesOnlyTypes) {
+  SpscRing<std::unique_ptr<int>> ring(2);
+  ring.Push(std::make_unique<int>(7));
+
+  std::unique_ptr<int> value;
+  EXPECT_TRUE(ring.Pop(value));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 7);
+}
+
+TEST(SpscRingTest, PreservesOrderAcrossThreads) {
+  constexpr int kCount = 200000;
+  SpscRing<int> ring(8);
+  std::thread producer([&]() {
+    for (int i = 0; i < kCount; i++) {
+      ring.Push(i);
+    }
+    ring.Close();
+  });
+
+  std::vector<int> received;
+  int value;
+  while (ring.Pop(value)) {
+    received.push_back(value);
+  }
+  producer.join();
+
+  ASSERT_EQ(received.size(), kCount);
+  for (int i = 0; i < kCount; i++) {
+    ASSERT_EQ(received[i], i);
+  }
+}
+
+}  // namespace
+}  // namespace util_concurrency
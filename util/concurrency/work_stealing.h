@@ -0,0 +1,104 @@
+#ifndef UTIL_CONCURRENCY_WORK_STEALING_H_
+#define UTIL_CONCURRENCY_WORK_STEALING_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util_concurrency {
+
+namespace work_stealing_internal {
+
+// The task indices [begin, end) that one worker has still to run. Its own
+// worker takes them from the front; thieves take the back half.
+struct alignas(64) Range {
+  std::mutex mutex;
+  size_t begin = 0;
+  size_t end = 0;
+
+  bool TakeFront(size_t& index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (begin == end) {
+      return false;
+    }
+    index = begin++;
+    return true;
+  }
+
+  // Gives `thief`, which must be empty, the back half of this range, rounded
+  // up so that a single index can be stolen.
+  bool StealInto(Range& thief) {
+    size_t stolen_begin;
+    size_t stolen_end;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (begin == end) {
+        return false;
+      }
+      stolen_begin = begin + (end - begin) / 2;
+      stolen_end = end;
+      end = stolen_begin;
+    }
+    std::lock_guard<std::mutex> lock(thief.mutex);
+    thief.begin = stolen_begin;
+    thief.end = stolen_end;
+    return true;
+  }
+};
+
+}  // namespace work_stealing_internal
+
+// Runs `task(i)` for every i in [0, num_tasks) on up to `num_threads` threads,
+// the calling thread among them, and returns once all have finished.
+//
+// Each thread starts with an equal, contiguous share of the indices and, when
+// that runs out, steals half of what the next busy thread has left. Threads
+// stay off each other's cache lines while they have work of their own, and
+// tasks whose costs differ by orders of magnitude still balance out.
+template <typename Task>
+void RunWorkStealing(size_t num_tasks, int num_threads, const Task& task) {
+  size_t num_workers = std::min<size_t>(std::max(num_threads, 1), num_tasks);
+  if (num_workers <= 1) {
+    for (size_t i = 0; i < num_tasks; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  std::vector<work_stealing_internal::Range> ranges(num_workers);
+  for (size_t worker = 0; worker < num_workers; worker++) {
+    ranges[worker].begin = num_tasks * worker / num_workers;
+    ranges[worker].end = num_tasks * (worker + 1) / num_workers;
+  }
+  auto worker = [&](size_t self) {
+    size_t i;
+    for (;;) {
+      while (ranges[self].TakeFront(i)) {
+        task(i);
+      }
+      // Nothing is ever added, so once every other range is empty the work
+      // left is all in progress.
+      bool stole = false;
+      for (size_t offset = 1; offset < num_workers && !stole; offset++) {
+        stole = ranges[(self + offset) % num_workers].StealInto(ranges[self]);
+      }
+      if (!stole) {
+        return;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_workers; i++) {
+    threads.emplace_back(worker, i);
+  }
+  worker(0);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace util_concurrency
+
+#endif  // UTIL_CONCURRENCY_WORK_STEALING_H_
@@ -0,0 +1,51 @@
+#include "util/concurrency/work_stealing.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace util_concurrency {
+namespace {
+
+TEST(WorkStealingTest, RunsEveryTaskOnce) {
+  for (int num_threads : {0, 1, 2, 3, 8}) {
+    for (size_t num_tasks : {0, 1, 2, 7, 1000}) {
+      std::vector<std::atomic<int>> runs(num_tasks);
+      RunWorkStealing(num_tasks, num_threads, [&](size_t i) { runs[i]++; });
+      for (size_t i = 0; i < num_tasks; i++) {
+        ASSERT_EQ(runs[i], 1) << num_threads << " " << num_tasks << " " << i;
+      }
+    }
+  }
+}
+
+TEST(WorkStealingTest, RunsOnTheCallingThreadAlone) {
+  std::set<std::thread::id> threads;
+  RunWorkStealing(10, 1, [&](size_t) {
+    threads.insert(std::this_thread::get_id());
+  });
+  EXPECT_EQ(threads, std::set<std::thread::id>{std::this_thread::get_id()});
+}
+
+TEST(WorkStealingTest, IdleThreadsStealFromBusyOnes) {
+  // All the slow tasks are in the first thread's share. Without stealing,
+  // that thread would run every one of them.
+  std::mutex mutex;
+  std::set<std::thread::id> slow_task_threads;
+  RunWorkStealing(64, 4, [&](size_t i) {
+    if (i < 16) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      std::lock_guard<std::mutex> lock(mutex);
+      slow_task_threads.insert(std::this_thread::get_id());
+    }
+  });
+  EXPECT_GT(slow_task_threads.size(), 1);
+}
+
+}  // namespace
+}  // namespace util_concurrency
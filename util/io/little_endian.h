@@ -0,0 +1,34 @@
+#ifndef UTIL_IO_LITTLE_ENDIAN_H_
+#define UTIL_IO_LITTLE_ENDIAN_H_
+
+#include <cstdint>
+#include <string>
+
+namespace util_io {
+
+// Appends `value` to `out` as 2 little-endian bytes.
+inline void PutUint16(std::string& out, uint16_t value) {
+  out.push_back(static_cast<char>(value & 0xff));
+  out.push_back(static_cast<char>(value >> 8));
+}
+
+// Appends `value` to `out` as 4 little-endian bytes.
+inline void PutUint32(std::string& out, uint32_t value) {
+  PutUint16(out, value & 0xffff);
+  PutUint16(out, value >> 16);
+}
+
+// Reads 2 little-endian bytes from `p`.
+inline uint16_t GetUint16(const char* p) {
+  return static_cast<uint16_t>(static_cast<unsigned char>(p[0]) |
+                               static_cast<unsigned char>(p[1]) << 8);
+}
+
+// Reads 4 little-endian bytes from `p`.
+inline uint32_t GetUint32(const char* p) {
+  return GetUint16(p) | static_cast<uint32_t>(GetUint16(p + 2)) << 16;
+}
+
+}  // namespace util_io
+
+#endif  // UTIL_IO_LITTLE_ENDIAN_H_
@@ -0,0 +1,81 @@
+#include "util/io/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utility>
+
+namespace util_io {
+
+constexpr size_t kReadChunkSize = 1 << 16;
+
+std::optional<MappedFile> MappedFile::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return {};
+  }
+  std::optional<MappedFile> file = FromFileDescriptor(fd);
+  close(fd);
+  return file;
+}
+
+std::optional<MappedFile> MappedFile::FromFileDescriptor(int fd) {
+  MappedFile file;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return {};
+  }
+  if (S_ISREG(st.st_mode) && st.st_size > 0) {
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      // Input is scanned front to back exactly once per pass.
+      madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+      file.mapping_ = mapping;
+      file.size_ = st.st_size;
+      return file;
+    }
+  }
+
+  // Not mappable, e.g. a pipe. Fall back to reading it all into memory.
+  char chunk[kReadChunkSize];
+  ssize_t n;
+  while ((n = read(fd, chunk, sizeof(chunk))) != 0) {
+    if (n < 0) {
+      return {};
+    }
+    file.buffer_.append(chunk, n);
+  }
+  return file;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    mapping_(std::exchange(other.mapping_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    buffer_(std::move(other.buffer_)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Unmap();
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    buffer_ = std::move(other.buffer_);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Unmap();
+}
+
+void MappedFile::Unmap() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, size_);
+    mapping_ = nullptr;
+    size_ = 0;
+  }
+}
+
+}  // namespace util_io
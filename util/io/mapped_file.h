@@ -0,0 +1,49 @@
+#ifndef UTIL_IO_MAPPED_FILE_H_
+#define UTIL_IO_MAPPED_FILE_H_
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace util_io {
+
+// A read-only view over the full contents of a file. Regular files are
+// memory-mapped so that no copy is made; anything that cannot be mapped (pipes,
+// terminals) is read into an owned buffer instead.
+class MappedFile final {
+ public:
+  // Opens and maps the file at `path`. Returns nothing if it cannot be read.
+  static std::optional<MappedFile> Open(const std::string& path);
+
+  // Maps or reads everything remaining on `fd`. The descriptor is not closed.
+  static std::optional<MappedFile> FromFileDescriptor(int fd);
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  // The contents of the file. Valid for as long as this object is alive.
+  std::string_view contents() const {
+    if (mapping_ != nullptr) {
+      return std::string_view(static_cast<const char*>(mapping_), size_);
+    }
+    return buffer_;
+  }
+
+ private:
+  MappedFile() {}
+
+  void Unmap();
+
+  void* mapping_ = nullptr;
+
+  size_t size_ = 0;
+
+  std::string buffer_;
+};
+
+}  // namespace util_io
+
+#endif  // UTIL_IO_MAPPED_FILE_H_
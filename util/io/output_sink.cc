@@ -0,0 +1,51 @@
+#include "util/io/output_sink.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+namespace util_io {
+
+OutputSink::OutputSink(int fd, size_t buffer_size)
+    : fd_(fd), buffer_(buffer_size) {}
+
+OutputSink::OutputSink(std::ostream& stream, size_t buffer_size)
+    : stream_(&stream), buffer_(buffer_size) {}
+
+OutputSink::~OutputSink() {
+  Flush();
+}
+
+bool OutputSink::Flush() {
+  const char* data = buffer_.data();
+  size_t remaining = used_;
+  flushed_ += used_;
+  used_ = 0;
+  if (stream_ != nullptr) {
+    stream_->write(data, remaining);
+    stream_->flush();
+    ok_ = ok_ && stream_->good();
+    return ok_;
+  }
+  while (ok_ && remaining > 0) {
+    ssize_t written = write(fd_, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ok_ = false;
+      break;
+    }
+    data += written;
+    remaining -= written;
+  }
+  return ok_;
+}
+
+void OutputSink::MakeRoom(size_t size) {
+  Flush();
+  if (buffer_.size() < size) {
+    buffer_.resize(size);
+  }
+}
+
+}  // namespace util_io
@@ -0,0 +1,75 @@
+#ifndef UTIL_IO_OUTPUT_SINK_H_
+#define UTIL_IO_OUTPUT_SINK_H_
+
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace util_io {
+
+// Collects output in one large buffer and hands it on in as few writes as
+// possible, so that producers can append small pieces, or encode straight into
+// the buffer, without a system call or stream flush per piece.
+class OutputSink final {
+ public:
+  static constexpr size_t kDefaultBufferSize = 1 << 20;
+
+  // Writes to `fd` with write(2). The descriptor is not closed.
+  explicit OutputSink(int fd, size_t buffer_size = kDefaultBufferSize);
+
+  // Writes to `stream`, e.g. a std::ostringstream.
+  explicit OutputSink(std::ostream& stream,
+                      size_t buffer_size = kDefaultBufferSize);
+
+  OutputSink(const OutputSink&) = delete;
+  OutputSink& operator=(const OutputSink&) = delete;
+
+  // Flushes anything still buffered.
+  ~OutputSink();
+
+  // Returns space for exactly `size` bytes at the end of the output, which
+  // the caller must fill before the next call. Grows the buffer if `size` is
+  // larger than it.
+  char* Append(size_t size) {
+    if (buffer_.size() - used_ < size) {
+      MakeRoom(size);
+    }
+    char* space = buffer_.data() + used_;
+    used_ += size;
+    return space;
+  }
+
+  void Write(std::string_view data) {
+    data.copy(Append(data.size()), data.size());
+  }
+
+  // Writes out everything buffered so far. Returns false if any write so far
+  // has failed.
+  bool Flush();
+
+  // The number of bytes appended so far, flushed or not.
+  size_t bytes_written() const {
+    return flushed_ + used_;
+  }
+
+ private:
+  void MakeRoom(size_t size);
+
+  int fd_ = -1;
+
+  std::ostream* stream_ = nullptr;
+
+  std::vector<char> buffer_;
+
+  size_t used_ = 0;
+
+  // Bytes handed on by earlier flushes.
+  size_t flushed_ = 0;
+
+  bool ok_ = true;
+};
+
+}  // namespace util_io
+
+#endif  // UTIL_IO_OUTPUT_SINK_H_
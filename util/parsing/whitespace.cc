@@ -1,8 +1,15 @@
 #include "util/parsing/whitespace.h"
 
 #include <ctype.h>
+#include <string.h>
+#include <cstdint>
 #include <iostream>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define UTIL_PARSING_X86 1
+#endif
+
 namespace util_parsing {
 
 void SkipWhitespaceAndComments(std::istream& input) {
@@ -25,4 +32,151 @@ void SkipWhitespaceAndComments(std::istream& input) {
   input.unget();
 }
 
+namespace {
+
+// The same characters as isspace() in the C locale.
+bool IsSpace(char ch) {
+  return ch == ' ' || (static_cast<unsigned char>(ch) - '\t') <= '\r' - '\t';
+}
+
+const char* FindNonSpaceScalar(const char* p, const char* end) {
+  while (p < end && IsSpace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+const char* FindNewlineScalar(const char* p, const char* end) {
+  const void* newline = memchr(p, '\n', end - p);
+  return newline == nullptr ? end : static_cast<const char*>(newline);
+}
+
+#ifdef UTIL_PARSING_X86
+
+// Each returns a bit per byte of `bytes`, set where the byte is whitespace.
+// Tab to carriage return are contiguous, so they are found with one unsigned
+// range check, done as min(x - '\t', 4) == x - '\t'.
+
+__attribute__((target("sse2")))
+int SpaceMask(__m128i bytes) {
+  __m128i control = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+  __m128i is_control = _mm_cmpeq_epi8(
+      _mm_min_epu8(control, _mm_set1_epi8('\r' - '\t')), control);
+  __m128i is_blank = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+  return _mm_movemask_epi8(_mm_or_si128(is_control, is_blank));
+}
+
+__attribute__((target("avx2")))
+uint32_t SpaceMask(__m256i bytes) {
+  __m256i control = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+  __m256i is_control = _mm256_cmpeq_epi8(
+      _mm256_min_epu8(control, _mm256_set1_epi8('\r' - '\t')), control);
+  __m256i is_blank = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+  return _mm256_movemask_epi8(_mm256_or_si256(is_control, is_blank));
+}
+
+__attribute__((target("sse2")))
+const char* FindNonSpaceSse2(const char* p, const char* end) {
+  for (; end - p >= 16; p += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    int other = ~SpaceMask(bytes) & 0xffff;
+    if (other != 0) {
+      return p + __builtin_ctz(other);
+    }
+  }
+  return FindNonSpaceScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+const char* FindNewlineSse2(const char* p, const char* end) {
+  for (; end - p >= 16; p += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    int newlines = _mm_movemask_epi8(
+        _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+    if (newlines != 0) {
+      return p + __builtin_ctz(newlines);
+    }
+  }
+  return FindNewlineScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* FindNonSpaceAvx2(const char* p, const char* end) {
+  for (; end - p >= 32; p += 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    uint32_t other = ~SpaceMask(bytes);
+    if (other != 0) {
+      return p + __builtin_ctz(other);
+    }
+  }
+  return FindNonSpaceSse2(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* FindNewlineAvx2(const char* p, const char* end) {
+  for (; end - p >= 32; p += 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    uint32_t newlines = _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+    if (newlines != 0) {
+      return p + __builtin_ctz(newlines);
+    }
+  }
+  return FindNewlineSse2(p, end);
+}
+
+#endif  // UTIL_PARSING_X86
+
+template <const char* (*FindNonSpace)(const char*, const char*),
+          const char* (*FindNewline)(const char*, const char*)>
+const char* Skip(const char* begin, const char* end) {
+  const char* p = begin;
+  for (;;) {
+    p = FindNonSpace(p, end);
+    if (p == end || *p != '/' || end - p < 2 || p[1] != '/') {
+      return p;
+    }
+    p = FindNewline(p + 2, end);
+  }
+}
+
+using SkipFn = const char* (*)(const char*, const char*);
+
+SkipFn SkipFunction(SimdLevel level) {
+  switch (level) {
+#ifdef UTIL_PARSING_X86
+    case SimdLevel::kAvx2:
+      return Skip<FindNonSpaceAvx2, FindNewlineAvx2>;
+    case SimdLevel::kSse2:
+      return Skip<FindNonSpaceSse2, FindNewlineSse2>;
+#endif
+    default:
+      return Skip<FindNonSpaceScalar, FindNewlineScalar>;
+  }
+}
+
+}  // namespace
+
+SimdLevel SupportedSimdLevel() {
+#ifdef UTIL_PARSING_X86
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::kAvx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return SimdLevel::kSse2;
+  }
+#endif
+  return SimdLevel::kScalar;
+}
+
+const char* SkipWhitespaceAndComments(const char* begin, const char* end) {
+  static const SkipFn skip = SkipFunction(SupportedSimdLevel());
+  return skip(begin, end);
+}
+
+const char* SkipWhitespaceAndComments(const char* begin, const char* end,
+                                      SimdLevel level) {
+  return SkipFunction(level)(begin, end);
+}
+
 }  // namespace util_parsing
@@ -5,4 +5,25 @@ namespace util_parsing {
 // Fast-forwards through `input` over any whitespace or c-style comments.
 void SkipWhitespaceAndComments(std::istream& input);
 
+// Buffer-based version of the above. Returns a pointer to the first character
+// in [begin, end) that is not whitespace or part of a comment, or `end`.
+// Scans 16 or 32 bytes at a time when the CPU supports it.
+const char* SkipWhitespaceAndComments(const char* begin, const char* end);
+
+// Instruction sets the buffer-based version can use.
+enum class SimdLevel {
+  kScalar,
+  kSse2,
+  kAvx2,
+};
+
+// Returns the best level that this CPU supports. The buffer-based version
+// uses it.
+SimdLevel SupportedSimdLevel();
+
+// The buffer-based version at a given level, which must be supported. For
+// tests and benchmarks.
+const char* SkipWhitespaceAndComments(const char* begin, const char* end,
+                                      SimdLevel level);
+
 }  // namespace util_parsing
@@ -0,0 +1,98 @@
+#include "util/parsing/whitespace.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+namespace util_parsing {
+namespace {
+
+constexpr SimdLevel kLevels[] = {
+  SimdLevel::kScalar,
+  SimdLevel::kSse2,
+  SimdLevel::kAvx2,
+};
+
+bool Supported(SimdLevel level) {
+  return static_cast<int>(level) <= static_cast<int>(SupportedSimdLevel());
+}
+
+// Skips with the stream-based version, which the others must agree with.
+size_t ExpectedSkip(std::string_view text) {
+  std::istringstream input{std::string(text)};
+  SkipWhitespaceAndComments(input);
+  std::streamoff position = input.tellg();
+  return position < 0 ? text.size() : position;
+}
+
+TEST(WhitespaceTest, SkipsWhitespaceAndComments) {
+  std::string text = "  \t\r\n// comment\n   // another\n\v\f@SP\n";
+
+  for (SimdLevel level : kLevels) {
+    if (!Supported(level)) {
+      continue;
+    }
+    const char* end = text.data() + text.size();
+    EXPECT_EQ(SkipWhitespaceAndComments(text.data(), end, level),
+              text.data() + text.find('@'));
+  }
+}
+
+TEST(WhitespaceTest, StopsAtSingleSlash) {
+  std::string text = std::string(40, ' ') + "/x";
+
+  for (SimdLevel level : kLevels) {
+    if (!Supported(level)) {
+      continue;
+    }
+    const char* end = text.data() + text.size();
+    EXPECT_EQ(SkipWhitespaceAndComments(text.data(), end, level),
+              text.data() + 40);
+  }
+}
+
+TEST(WhitespaceTest, ReturnsEndInUnterminatedComment) {
+  std::string text = "\n\n// no newline" + std::string(50, 'x');
+
+  for (SimdLevel level : kLevels) {
+    if (!Supported(level)) {
+      continue;
+    }
+    const char* end = text.data() + text.size();
+    EXPECT_EQ(SkipWhitespaceAndComments(text.data(), end, level), end);
+  }
+}
+
+TEST(WhitespaceTest, AgreesWithStreamVersionOnRandomText) {
+  constexpr char kAlphabet[] = {' ', ' ', '\t', '\n', '\n', '\r', '\v', '\f',
+                                '/', '/', '/', 'A', '@', '\x85', '\xa0'};
+  std::mt19937 random(1);
+  for (int i = 0; i < 2000; i++) {
+    std::string text(random() % 100, ' ');
+    for (char& ch : text) {
+      ch = kAlphabet[random() % sizeof(kAlphabet)];
+    }
+    size_t expected = ExpectedSkip(text);
+
+    for (SimdLevel level : kLevels) {
+      if (!Supported(level)) {
+        continue;
+      }
+      const char* end = text.data() + text.size();
+      ASSERT_EQ(SkipWhitespaceAndComments(text.data(), end, level) -
+                    text.data(),
+                expected)
+          << "level " << static_cast<int>(level) << " on '" << text << "'";
+    }
+    EXPECT_EQ(SkipWhitespaceAndComments(text.data(),
+                                        text.data() + text.size()) -
+                  text.data(),
+              expected);
+  }
+}
+
+}  // namespace
+}  // namespace util_parsing